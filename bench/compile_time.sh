@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+#
+# compile_time.sh
+#
+#  What including each header costs a translation unit: the size of the
+#  preprocessed output and the time the compiler takes to parse it
+#  (-fsyntax-only, best of REPS runs). An empty file and <cstdint> give the
+#  baseline. With --module the cost of `import xoshiro;` is measured as well,
+#  after building the module once.
+#
+#  --json writes the parse times in the format of xoshiro256_bench --json, so
+#  tools/bench_compare can gate compile time the same way as run time.
+#
+#  CXX=g++ CXXFLAGS=-std=c++20 REPS=10 bench/compile_time.sh [--module] [--json file]
+#
+set -euo pipefail
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+cxx=${CXX:-g++}
+flags=${CXXFLAGS:--std=c++17}
+reps=${REPS:-10}
+module=0
+json=""
+while [ $# -gt 0 ]; do
+	case "$1" in
+	--module) module=1 ;;
+	--json) json=$2; shift ;;
+	*) echo "usage: $0 [--module] [--json file]" >&2; exit 2 ;;
+	esac
+	shift
+done
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# nanoseconds of the fastest of $reps runs of "$@"
+best_ns() {
+	local best="" start end t
+	for _ in $(seq "$reps"); do
+		start=$(date +%s%N)
+		"$@" >/dev/null
+		end=$(date +%s%N)
+		t=$((end - start))
+		if [ -z "$best" ] || [ "$t" -lt "$best" ]; then best=$t; fi
+	done
+	echo "$best"
+}
+
+# nanoseconds as milliseconds
+ms() {
+	awk -v ns="$1" 'BEGIN { printf "%.3f", ns / 1000000 }'
+}
+
+names=()
+times=()
+
+# measure NAME FILE [extra flags...]
+measure() {
+	local name=$1 src=$2
+	shift 2
+	local bytes lines ns
+	bytes=$($cxx $flags -I"$root" "$@" -E -P "$src" | wc -c)
+	lines=$($cxx $flags -I"$root" "$@" -E -P "$src" | wc -l)
+	ns=$(best_ns $cxx $flags -I"$root" "$@" -fsyntax-only "$src")
+	printf "%-34s %10d %8d %10.1f\n" "$name" "$bytes" "$lines" "$(ms "$ns")"
+	names+=("$name")
+	times+=("$ns")
+}
+
+printf "%-34s %10s %8s %10s\n" "include" "bytes" "lines" "parse ms"
+: > "$work/empty.cpp"
+measure "(empty file)" "$work/empty.cpp"
+echo "#include <cstdint>" > "$work/cstdint.cpp"
+measure "<cstdint>" "$work/cstdint.cpp"
+for h in xoshiro256_core.hpp xoshiro256_distributions.hpp xoshiro256_io.hpp xoshiro256.hpp \
+		xoshiro256_array.hpp xoshiro256_interleaved.hpp xoshiro256_iterator.hpp xoshiro256_parallel.hpp \
+		xoshiro256_pool.hpp \
+		xoshiro256_feeder.hpp xoshiro256_shm.hpp xoshiro256_ranges.hpp xoshiro256_replay.hpp xoshiro256_instrument.hpp \
+		xoshiro128.hpp xoshiro128_lanes.hpp xoshiro512.hpp xoroshiro1024.hpp \
+		xoshiro256_constexpr.hpp; do
+	echo "#include \"$h\"" > "$work/$h.cpp"
+	measure "$h" "$work/$h.cpp"
+done
+
+if [ "$module" = 1 ]; then
+	# the module is built in the scratch directory, where the importer finds gcm.cache
+	(cd "$work" && $cxx -std=c++20 -fmodules-ts -I"$root" -c -x c++ "$root/xoshiro256.cppm" -o xoshiro256.o)
+	echo "import xoshiro;" > "$work/import.cpp"
+	ns=$(cd "$work" && best_ns $cxx -std=c++20 -fmodules-ts -fsyntax-only import.cpp)
+	printf "%-34s %10s %8s %10.1f\n" "import xoshiro;" "-" "-" "$(ms "$ns")"
+	names+=("import xoshiro")
+	times+=("$ns")
+fi
+
+if [ -n "$json" ]; then
+	{
+		printf '{\n  "benchmark": "xoshiro256-compile",\n  "repetitions": %d,\n  "results": [\n' "$reps"
+		for i in "${!names[@]}"; do
+			t=$(ms "${times[$i]}")
+			sep=","
+			[ "$i" -eq $((${#names[@]} - 1)) ] && sep=""
+			printf '    {"name": "parse/%s", "unit": "ms", "median": %s, "samples": [%s]}%s\n' \
+				"${names[$i]}" "$t" "$t" "$sep"
+		done
+		printf '  ]\n}\n'
+	} > "$json"
+fi
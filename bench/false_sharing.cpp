@@ -0,0 +1,77 @@
+/*
+ * false_sharing.cpp
+ *
+ *  Scaling of per-thread engines stored in a plain std::vector<xoshiro256ss>
+ *  (40 bytes each, so neighbours share cache lines) against per_thread_engines
+ *  (one engine per cache line). Every thread draws the same number of values
+ *  from its own engine; the time per draw should stay flat as threads are added
+ *  when there is no false sharing.
+ *
+ *  g++ -std=c++11 -O2 -pthread -I.. false_sharing.cpp -o false_sharing
+ *  ./false_sharing [draws per thread] [max threads]
+ */
+#include "../xoshiro256_parallel.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+ * runs f(t) on threads 0..threads-1 and returns the wall time in seconds
+ */
+template <class F>
+double timed_run(unsigned threads, F f){
+	std::vector<std::thread> pool;
+	const auto start = std::chrono::steady_clock::now();
+	for(unsigned t = 0; t < threads; t++)
+		pool.emplace_back(f, t);
+	for(auto &t : pool)
+		t.join();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv){
+	const uint64_t draws = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000;
+	unsigned max_threads = argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+	if(max_threads == 0)
+		max_threads = 1;
+	std::vector<uint64_t> sink(max_threads * 8);
+	const xoshiro256ss base(1, 2, 3, 4);
+
+	// powers of two below max_threads, then max_threads itself
+	std::vector<unsigned> counts;
+	for(unsigned threads = 1; threads < max_threads; threads *= 2)
+		counts.push_back(threads);
+	counts.push_back(max_threads);
+
+	printf("threads  vector ns/draw  padded ns/draw\n");
+	for(unsigned threads : counts){
+		std::vector<xoshiro256ss> packed(threads, base);
+		for(unsigned t = 0; t < threads; t++)
+			for(unsigned j = 0; j < t; j++)
+				packed[t].jump();
+		const double packed_s = timed_run(threads, [&](unsigned t){
+			uint64_t sum = 0;
+			for(uint64_t i = 0; i < draws; i++)
+				sum += packed[t]();
+			sink[8*t] = sum;
+		});
+
+		per_thread_engines<> padded(threads, base);
+		const double padded_s = timed_run(threads, [&](unsigned t){
+			xoshiro256ss &e = padded[t];
+			uint64_t sum = 0;
+			for(uint64_t i = 0; i < draws; i++)
+				sum += e();
+			sink[8*t] = sum;
+		});
+
+		printf("%7u  %14.3f  %14.3f\n", threads, packed_s * 1e9 / draws, padded_s * 1e9 / draws);
+	}
+	uint64_t check = 0;
+	for(uint64_t v : sink)
+		check ^= v;
+	printf("(checksum %016llx)\n", (unsigned long long)check);
+	return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * latency.cpp
+ *
+ *  Per-call latency of the engines and the distribution functions. The
+ *  throughput numbers of xoshiro256_bench average over millions of calls and
+ *  hide the tail: uniform() and geometric() retry on rejected values, and
+ *  exponential() and geometric() pay for log(). Here every call is timed on its
+ *  own between serialized time stamp reads (lfence; rdtsc; lfence before and
+ *  rdtscp; lfence after on x86, clock_gettime elsewhere), the cost of an empty
+ *  measurement is subtracted, and the distribution of the remaining ticks is
+ *  reported as percentiles and a log2 histogram.
+ *
+ *  Ticks are time stamp counter ticks, which run at a fixed rate and are not
+ *  core cycles when the clock scales. --perf adds a second pass that counts real
+ *  core cycles, instructions and branch misses with perf_event_open over whole
+ *  batches of calls (Linux only, needs kernel.perf_event_paranoid <= 2 or the
+ *  capability), and reports them per call with the IPC.
+ *
+ *  g++ -std=c++17 -O2 -I.. latency.cpp -o latency
+ *  ./latency [--samples N] [--filter text] [--histogram] [--perf]
+ */
+#include "../xoshiro256.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+volatile uint64_t sink; // results go here so the calls aren't optimized away
+
+/*
+ * hides where a pointer came from, so calls through it stay virtual
+ */
+template <class T>
+T* opaque(T *p){
+	asm volatile("" : "+r"(p));
+	return p;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/*
+ * time stamp before the measured code: the lfences keep earlier instructions
+ * from finishing after the read and later ones from starting before it
+ */
+inline uint64_t ticks_begin(){
+	uint32_t lo, hi;
+	asm volatile("lfence\n\trdtsc\n\tlfence" : "=a"(lo), "=d"(hi) :: "memory");
+	return (uint64_t)hi << 32 | lo;
+}
+
+/*
+ * time stamp after the measured code: rdtscp waits for everything before it
+ */
+inline uint64_t ticks_end(){
+	uint32_t lo, hi, aux;
+	asm volatile("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi), "=c"(aux) :: "memory");
+	return (uint64_t)hi << 32 | lo;
+}
+#else
+/*
+ * nanoseconds, for targets without a time stamp counter
+ */
+inline uint64_t ticks_begin(){
+	timespec ts;
+	asm volatile("" ::: "memory");
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	asm volatile("" ::: "memory");
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+inline uint64_t ticks_end(){
+	return ticks_begin();
+}
+#endif
+
+/*
+ * core cycles, instructions and branch misses of the calling thread, read as
+ * one group so the three counts cover the same instructions
+ */
+class perf_counters {
+public:
+	perf_counters(); // opens the group, ok() tells whether it worked
+	~perf_counters();
+	bool ok() const { return fd_[0] >= 0; } // false when perf_event_open isn't available
+	void start(); // resets and enables the group
+	void stop(uint64_t *out); // disables the group, out[3] = cycles, instructions, branch misses
+private:
+	int fd_[3]; // group leader first
+};
+
+#ifdef __linux__
+/*
+ * user space only, so the counts don't depend on what the kernel was doing
+ */
+perf_counters::perf_counters(){
+	const uint64_t config[3] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES };
+	for(int i = 0; i < 3; i++)
+		fd_[i] = -1;
+	for(int i = 0; i < 3; i++){
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config[i];
+		attr.disabled = i == 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		fd_[i] = syscall(SYS_perf_event_open, &attr, 0, -1, i ? fd_[0] : -1, 0);
+		if(fd_[i] < 0){
+			for(int j = 0; j < i; j++)
+				close(fd_[j]);
+			fd_[0] = -1;
+			return;
+		}
+	}
+}
+
+perf_counters::~perf_counters(){
+	if(ok())
+		for(int i = 0; i < 3; i++)
+			close(fd_[i]);
+}
+
+void perf_counters::start(){
+	ioctl(fd_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counters::stop(uint64_t *out){
+	ioctl(fd_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	uint64_t buf[4] = { 0, 0, 0, 0 }; // nr, then the values in group order
+	if(read(fd_[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf))
+		buf[1] = buf[2] = buf[3] = 0;
+	for(int i = 0; i < 3; i++)
+		out[i] = buf[i+1];
+}
+#else
+perf_counters::perf_counters(){ fd_[0] = fd_[1] = fd_[2] = -1; }
+perf_counters::~perf_counters(){}
+void perf_counters::start(){}
+void perf_counters::stop(uint64_t *out){ out[0] = out[1] = out[2] = 0; }
+#endif
+
+/*
+ * holds the command line, the measured overhead and the perf group
+ */
+struct harness {
+	size_t samples = 200000;
+	std::string filter;
+	bool histogram = false;
+	perf_counters *perf = nullptr;
+	uint64_t overhead = 0; // ticks of an empty measurement, subtracted from every sample
+
+	/*
+	 * times `samples` single calls of f, after as many untimed warm-up calls
+	 */
+	template <class F>
+	std::vector<uint64_t> measure(F f){
+		std::vector<uint64_t> t(samples);
+		for(size_t i = 0; i < samples; i++)
+			sink = (uint64_t)f();
+		for(size_t i = 0; i < samples; i++){
+			const uint64_t a = ticks_begin();
+			const uint64_t v = (uint64_t)f();
+			const uint64_t b = ticks_end();
+			sink = v;
+			t[i] = b - a;
+		}
+		return t;
+	}
+
+	/*
+	 * the median of empty measurements. the minimum would over-subtract, since
+	 * the empty measurement is itself noisy.
+	 */
+	void calibrate(){
+		std::vector<uint64_t> t = measure([]{ return 0; });
+		std::sort(t.begin(), t.end());
+		overhead = t[t.size()/2];
+		printf("measurement overhead: %llu ticks (subtracted below)\n\n", (unsigned long long)overhead);
+		printf("%-40s %7s %7s %7s %7s %8s %8s %9s\n", "", "min", "p50", "p90", "p99", "p99.9", "max", "mean");
+	}
+
+	/*
+	 * measures f and prints its percentiles, histogram and perf counts
+	 */
+	template <class F>
+	void run(const std::string &name, F f){
+		if(!filter.empty() && name.find(filter) == std::string::npos)
+			return;
+		std::vector<uint64_t> t = measure(f);
+		double mean = 0;
+		for(uint64_t &x : t){
+			x = x > overhead ? x - overhead : 0;
+			mean += x;
+		}
+		mean /= t.size();
+		std::sort(t.begin(), t.end());
+		const auto pct = [&](double p){ return (unsigned long long)t[std::min(t.size()-1, (size_t)(p * t.size()))]; };
+		printf("%-40s %7llu %7llu %7llu %7llu %8llu %8llu %9.2f\n", name.c_str(),
+				(unsigned long long)t.front(), pct(0.5), pct(0.9), pct(0.99), pct(0.999), (unsigned long long)t.back(), mean);
+		if(histogram)
+			print_histogram(t);
+		if(perf)
+			count(f);
+	}
+
+	/*
+	 * log2 buckets of ticks: bucket b holds [2^(b-1), 2^b), bucket 0 holds 0
+	 */
+	void print_histogram(const std::vector<uint64_t> &t){
+		size_t bucket[65] = { 0 };
+		for(uint64_t x : t)
+			bucket[x ? 64 - __builtin_clzll(x) : 0]++;
+		for(int b = 0; b < 65; b++){
+			if(!bucket[b])
+				continue;
+			const double share = (double)bucket[b] / t.size();
+			printf("    %8llu..%-8llu %8.4f%% |%.*s\n", b ? 1ULL << (b-1) : 0ULL, b ? (1ULL << b) - 1 : 0ULL,
+					100 * share, (int)std::ceil(50 * share), "##################################################");
+		}
+	}
+
+	/*
+	 * counts over a batch of untimed calls, so the per-call figures have no
+	 * measurement code in them
+	 */
+	template <class F>
+	void count(F f){
+		uint64_t c[3];
+		perf->start();
+		for(size_t i = 0; i < samples; i++)
+			sink = (uint64_t)f();
+		perf->stop(c);
+		const double n = samples;
+		printf("    perf: %.2f cycles, %.2f instructions, %.4f branch misses per call, IPC %.2f\n",
+				c[0] / n, c[1] / n, c[2] / n, c[0] ? (double)c[1] / c[0] : 0.0);
+	}
+};
+
+int main(int argc, char **argv){
+	harness h;
+	bool want_perf = false;
+	for(int i = 1; i < argc; i++){
+		if(!strcmp(argv[i], "--samples") && i + 1 < argc)
+			h.samples = strtoull(argv[++i], nullptr, 10);
+		else if(!strcmp(argv[i], "--filter") && i + 1 < argc)
+			h.filter = argv[++i];
+		else if(!strcmp(argv[i], "--histogram"))
+			h.histogram = true;
+		else if(!strcmp(argv[i], "--perf"))
+			want_perf = true;
+		else {
+			fprintf(stderr, "usage: %s [--samples N] [--filter text] [--histogram] [--perf]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(h.samples < 1)
+		h.samples = 1;
+	perf_counters perf;
+	if(want_perf){
+		if(perf.ok())
+			h.perf = &perf;
+		else
+			fprintf(stderr, "perf_event_open failed, running without counters\n");
+	}
+	h.calibrate();
+
+	// the engines, with and without the vtable
+	splitmix64 sm(1);
+	h.run("splitmix64/operator()", [&]{ return sm(); });
+	xoshiro256ss ss(1, 2, 3, 4);
+	xoshiro256ss *pss = opaque(&ss);
+	h.run("xoshiro256ss/operator() virtual", [=]{ return (*pss)(); });
+	h.run("xoshiro256ss/operator() non-virtual", [&]{ return ss.xoshiro256ss::operator()(); });
+	xoshiro256p pp(1, 2, 3, 4);
+	xoshiro256ss *ppp = opaque<xoshiro256ss>(&pp);
+	h.run("xoshiro256p/operator() virtual", [=]{ return (*ppp)(); });
+	std::mt19937_64 mt(1);
+	h.run("std::mt19937_64/operator()", [&]{ return mt(); });
+
+	// the distributions, and log() on its own to separate its share
+	h.run("xoshiro256ss/uniform", [=]{ return pss->uniform(0.0, 1.0) * 1e6; });
+	h.run("xoshiro256ss/exponential", [=]{ return pss->exponential(2.0) * 1e6; });
+	h.run("xoshiro256ss/geometric", [=]{ return pss->geometric(0.1); });
+	volatile double arg = 0.5;
+	h.run("std::log", [&]{ return std::log(arg) * 1e6; });
+	std::uniform_real_distribution<double> uni(0.0, 1.0);
+	std::exponential_distribution<double> expo(0.5);
+	std::geometric_distribution<int> geo(0.1);
+	h.run("std::uniform_real_distribution", [&]{ return uni(*pss) * 1e6; });
+	h.run("std::exponential_distribution", [&]{ return expo(*pss) * 1e6; });
+	h.run("std::geometric_distribution", [&]{ return geo(*pss); });
+
+	// the jumps, whose cost grows with the argument
+	h.run("xoshiro256ss/jump", [=]{ pss->jump(); return pss->s[0]; });
+	h.run("xoshiro256ss/advance(2^40)", [=]{ pss->advance(UINT64_C(1) << 40); return pss->s[0]; });
+	return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * xoshiro256_bench.cpp
+ *
+ *  Throughput of the engines, the 32-bit xoshiro128 family and the large-state
+ *  xoshiro512 and xoroshiro1024 among them, the bulk paths and the distribution
+ *  functions, next to std::mt19937_64 and the <random> distributions, plus the
+ *  latency of the jump functions. The lane engines only use AVX2 or AVX-512 if
+ *  the build allows it (-march=native). Every benchmark is repeated and all
+ *  samples are kept, so the JSON output can be compared across commits with
+ *  tools/bench_compare.
+ *
+ *  g++ -std=c++17 -O2 -pthread -I.. xoshiro256_bench.cpp -o xoshiro256_bench
+ *  ./xoshiro256_bench [--reps N] [--values N] [--filter text] [--json file|-]
+ */
+#include "../xoshiro128.hpp"
+#include "../xoshiro128_lanes.hpp"
+#include "../xoshiro512.hpp"
+#include "../xoroshiro1024.hpp"
+#include "../xoshiro256.hpp"
+#include "../xoshiro256_array.hpp"
+#include "../xoshiro256_interleaved.hpp"
+#include "../xoshiro256_parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * one benchmark: a name, the unit it reports in and the per-repetition samples
+ */
+struct result {
+	std::string name;
+	std::string unit; // "ns/value" or "ns/op"
+	std::vector<double> samples;
+	double median() const;
+};
+
+/*
+ * median of the samples
+ */
+double result::median() const{
+	std::vector<double> v(samples);
+	std::sort(v.begin(), v.end());
+	const size_t n = v.size();
+	return n % 2 ? v[n/2] : (v[n/2-1] + v[n/2]) / 2;
+}
+
+volatile uint64_t sink; // results go here so the loops aren't optimized away
+
+/*
+ * hides where a pointer came from, so the compiler has to make real virtual
+ * calls through it the way it would across translation units
+ */
+template <class T>
+T* opaque(T *p){
+	asm volatile("" : "+r"(p));
+	return p;
+}
+
+/*
+ * holds the command line and the collected results
+ */
+struct runner {
+	int reps = 15;
+	size_t values = 1 << 20;
+	std::string filter;
+	std::vector<result> results;
+
+	/*
+	 * runs body reps times. body does `count` units of work and returns a value
+	 * to feed the sink.
+	 */
+	void run(const std::string &name, const std::string &unit, size_t count,
+			const std::function<uint64_t()> &body){
+		if(!filter.empty() && name.find(filter) == std::string::npos)
+			return;
+		result r;
+		r.name = name;
+		r.unit = unit;
+		sink = body(); // warm up
+		for(int i = 0; i < reps; i++){
+			const auto start = std::chrono::steady_clock::now();
+			sink = body();
+			const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+			r.samples.push_back(ns / count);
+		}
+		fprintf(stderr, "%-44s %10.3f %-8s %12.1f M/s\n", name.c_str(), r.median(), unit.c_str(), 1e3 / r.median());
+		results.push_back(r);
+	}
+
+	/*
+	 * same as run() for functions producing one value per call
+	 */
+	template <class F>
+	void values_of(const std::string &name, F f){
+		const size_t n = values;
+		run(name, "ns/value", n, [=]() mutable {
+			uint64_t acc = 0;
+			for(size_t i = 0; i < n; i++)
+				acc += (uint64_t)f();
+			return acc;
+		});
+	}
+};
+
+/*
+ * JSON for bench_compare: one entry per benchmark, with all its samples
+ */
+void write_json(FILE *f, const runner &r){
+	fprintf(f, "{\n  \"benchmark\": \"xoshiro256\",\n  \"repetitions\": %d,\n  \"values\": %zu,\n  \"results\": [\n", r.reps, r.values);
+	for(size_t i = 0; i < r.results.size(); i++){
+		const result &x = r.results[i];
+		fprintf(f, "    {\"name\": \"%s\", \"unit\": \"%s\", \"median\": %.6g, \"per_second\": %.6g, \"samples\": [",
+				x.name.c_str(), x.unit.c_str(), x.median(), 1e9 / x.median());
+		for(size_t j = 0; j < x.samples.size(); j++)
+			fprintf(f, "%s%.6g", j ? ", " : "", x.samples[j]);
+		fprintf(f, "]}%s\n", i + 1 < r.results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char **argv){
+	runner r;
+	const char *json = nullptr;
+	for(int i = 1; i < argc; i++){
+		if(!strcmp(argv[i], "--reps") && i + 1 < argc)
+			r.reps = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--values") && i + 1 < argc)
+			r.values = strtoull(argv[++i], nullptr, 10);
+		else if(!strcmp(argv[i], "--filter") && i + 1 < argc)
+			r.filter = argv[++i];
+		else if(!strcmp(argv[i], "--json") && i + 1 < argc)
+			json = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--reps N] [--values N] [--filter text] [--json file|-]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(r.reps < 1)
+		r.reps = 1;
+
+	// raw engines
+	splitmix64 sm(1);
+	r.values_of("splitmix64/operator()", [&]{ return sm(); });
+	xoshiro256ss ss(1, 2, 3, 4);
+	xoshiro256ss *pss = opaque(&ss);
+	r.values_of("xoshiro256ss/operator()", [=]{ return (*pss)(); });
+	xoshiro256p pp(1, 2, 3, 4);
+	xoshiro256ss *ppp = opaque<xoshiro256ss>(&pp);
+	r.values_of("xoshiro256p/operator()", [=]{ return (*ppp)(); });
+	r.values_of("xoshiro256ss/operator() non-virtual", [&]{ return ss.xoshiro256ss::operator()(); });
+	xoshiro128ss ss128(1, 2, 3, 4);
+	xoshiro128ss *pss128 = opaque(&ss128);
+	r.values_of("xoshiro128ss/operator()", [=]{ return (*pss128)(); });
+	const uint64_t seed8[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	const uint64_t seed16[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+	xoshiro512ss ss512(seed8);
+	xoshiro512ss *pss512 = opaque(&ss512);
+	r.values_of("xoshiro512ss/operator()", [=]{ return (*pss512)(); });
+	xoroshiro1024ss ss1024(seed16);
+	xoroshiro1024ss *pss1024 = opaque(&ss1024);
+	r.values_of("xoroshiro1024ss/operator()", [=]{ return (*pss1024)(); });
+	std::mt19937_64 mt(1);
+	r.values_of("std::mt19937_64/operator()", [&]{ return mt(); });
+
+	// bulk paths
+	std::vector<uint64_t> buf(r.values);
+	r.run("splitmix64/fill", "ns/value", buf.size(), [&]{
+		sm.fill(buf.data(), buf.size());
+		return buf[buf.size()/2];
+	});
+	engine_array arr(1024, 1);
+	r.run("engine_array<1024>/next", "ns/value", buf.size() / 1024 * 1024, [&]{
+		for(size_t i = 0; i + 1024 <= buf.size(); i += 1024)
+			arr.next(buf.data() + i);
+		return buf[0];
+	});
+	interleaved<2> il2(ss);
+	r.run("interleaved<2>/fill", "ns/value", buf.size(), [&]{
+		il2.fill(buf.data(), buf.size());
+		return buf[0];
+	});
+	interleaved<4> il4(ss);
+	r.run("interleaved<4>/fill", "ns/value", buf.size(), [&]{
+		il4.fill(buf.data(), buf.size());
+		return buf[0];
+	});
+	std::vector<uint32_t> buf32(r.values);
+	std::vector<float> buff(r.values);
+	xoshiro128x8 x8(ss128);
+	r.run("xoshiro128_lanes<8>/fill", "ns/value", buf32.size(), [&]{
+		x8.fill(buf32.data(), buf32.size());
+		return buf32[0];
+	});
+	xoshiro128x16 x16(ss128);
+	r.run("xoshiro128_lanes<16>/fill", "ns/value", buf32.size(), [&]{
+		x16.fill(buf32.data(), buf32.size());
+		return buf32[0];
+	});
+	r.run("xoshiro128_lanes<16>/fill_uniform", "ns/value", buff.size(), [&]{
+		x16.fill_uniform(buff.data(), buff.size(), 0.0f, 1.0f);
+		return (uint64_t)(buff[0] * 1e6f);
+	});
+	r.run("parallel_fill/1 thread", "ns/value", buf.size(), [&]{
+		parallel_fill(buf.data(), buf.size(), 1, 1);
+		return buf[0];
+	});
+	r.run("parallel_fill/all threads", "ns/value", buf.size(), [&]{
+		parallel_fill(buf.data(), buf.size(), 1, 0);
+		return buf[0];
+	});
+	r.run("parallel_fill<xoshiro512ss>/1 thread", "ns/value", buf.size(), [&]{
+		parallel_fill<xoshiro512ss>(buf.data(), buf.size(), 1, 1);
+		return buf[0];
+	});
+
+	// distributions: the homemade ones against <random> on both engines
+	r.values_of("xoshiro256ss/uniform", [=]{ return pss->uniform(0.0, 1.0) * 1e6; });
+	r.values_of("xoshiro256ss/exponential", [=]{ return pss->exponential(2.0) * 1e6; });
+	r.values_of("xoshiro256ss/geometric", [=]{ return pss->geometric(0.1); });
+	r.values_of("xoshiro128ss/uniform", [=]{ return pss128->uniform(0.0f, 1.0f) * 1e6f; });
+	std::uniform_real_distribution<double> uni(0.0, 1.0);
+	std::exponential_distribution<double> expo(0.5);
+	std::geometric_distribution<int> geo(0.1);
+	r.values_of("std::uniform_real_distribution/xoshiro256ss", [&]{ return uni(*pss) * 1e6; });
+	r.values_of("std::exponential_distribution/xoshiro256ss", [&]{ return expo(*pss) * 1e6; });
+	r.values_of("std::geometric_distribution/xoshiro256ss", [&]{ return geo(*pss); });
+	r.values_of("std::uniform_real_distribution/mt19937_64", [&]{ return uni(mt) * 1e6; });
+	r.values_of("std::exponential_distribution/mt19937_64", [&]{ return expo(mt) * 1e6; });
+	r.values_of("std::geometric_distribution/mt19937_64", [&]{ return geo(mt); });
+
+	// jump latency
+	const size_t jumps = 2000;
+	r.run("xoshiro256ss/jump", "ns/op", jumps, [&]{
+		for(size_t i = 0; i < jumps; i++)
+			pss->jump();
+		return pss->s[0];
+	});
+	r.run("xoshiro256ss/long_jump", "ns/op", jumps, [&]{
+		for(size_t i = 0; i < jumps; i++)
+			pss->long_jump();
+		return pss->s[0];
+	});
+	r.run("xoshiro256ss/advance(2^40+i)", "ns/op", jumps / 10, [&]{
+		for(size_t i = 0; i < jumps / 10; i++)
+			pss->advance((UINT64_C(1) << 40) + i);
+		return pss->s[0];
+	});
+	r.run("xoshiro256ss/jump(1000000+i)", "ns/op", jumps / 10, [&]{
+		for(size_t i = 0; i < jumps / 10; i++)
+			pss->jump(1000000 + i);
+		return pss->s[0];
+	});
+	r.run("xoshiro512ss/jump", "ns/op", jumps / 10, [&]{
+		for(size_t i = 0; i < jumps / 10; i++)
+			pss512->jump();
+		return pss512->s[0];
+	});
+	r.run("xoroshiro1024ss/jump", "ns/op", jumps / 10, [&]{
+		for(size_t i = 0; i < jumps / 10; i++)
+			pss1024->jump();
+		return pss1024->s[0];
+	});
+
+	if(json){
+		FILE *f = strcmp(json, "-") ? fopen(json, "w") : stdout;
+		if(!f){
+			perror(json);
+			return 1;
+		}
+		write_json(f, r);
+		if(f != stdout)
+			fclose(f);
+	}
+	return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * xoshiro256.cpp
+ *
+ *  The compiled library: the one translation unit that defines the non-template
+ *  functions of the headers when they are used with XOSHIRO256_LIBRARY, and
+ *  instantiates the engines, engine_array and stream_registry, which the headers
+ *  declare extern in that mode. See the note at the top of xoshiro256_core.hpp.
+ */
+#ifndef XOSHIRO256_LIBRARY
+#define XOSHIRO256_LIBRARY
+#endif
+#define XOSHIRO256_SOURCE
+
+#include "xoshiro256_core.hpp"
+#include "xoshiro128.hpp"
+#include "xoshiro512.hpp"
+#include "xoroshiro1024.hpp"
+#include "xoshiro256_distributions.hpp"
+#include "xoshiro256_io.hpp"
+#include "xoshiro256_array.hpp"
+#include "xoshiro256_feeder.hpp"
+#include "xoshiro256_instrument.hpp"
+#include "xoshiro256_replay.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include "xoshiro256_shm.hpp"
+#endif
+
+using namespace xoshiro_detail;
+
+template class xoshiro_engine<xoshiro256_family>;
+template class xoshiro_scrambled<xoshiro256_family, xoshiro256_family::plus>;
+template class xoshiro_engine<xoshiro128_family>;
+template class xoshiro_scrambled<xoshiro128_family, xoshiro128_family::plus>;
+template class xoshiro_scrambled<xoshiro128_family, xoshiro128_family::plusplus>;
+template class xoshiro_engine<xoshiro512_family>;
+template class xoshiro_scrambled<xoshiro512_family, xoshiro512_family::plus>;
+template class xoshiro_scrambled<xoshiro512_family, xoshiro512_family::plusplus>;
+template class xoshiro_engine<xoroshiro1024_family>;
+template class xoshiro_scrambled<xoroshiro1024_family, xoroshiro1024_family::star>;
+template class basic_engine_array<xoshiro256ss>;
+#if defined(__unix__) || defined(__APPLE__)
+template class basic_stream_registry<xoshiro256ss>;
+#endif
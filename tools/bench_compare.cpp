@@ -0,0 +1,339 @@
+/*
+ * bench_compare.cpp
+ *
+ *  Compares two JSON files written by bench/xoshiro256_bench --json and exits
+ *  with status 1 if anything got slower, so it can gate a header upgrade in CI:
+ *
+ *      xoshiro256_bench --json base.json      (old header)
+ *      xoshiro256_bench --json new.json       (new header)
+ *      bench_compare base.json new.json
+ *
+ *  All the benchmark's units are times per value or per operation, so lower is
+ *  better. For every benchmark in both files the medians of the repeated samples
+ *  are compared. A change only counts when it is larger than both --threshold
+ *  percent and --sigma times the noise. The noise is the standard error of the
+ *  difference of the two medians, estimated from the median absolute deviation
+ *  of each file's samples (1.4826 * MAD for sigma, 1.2533 * sigma / sqrt(n) for
+ *  the median). One noisy run then can't fail the gate, and a small but steady
+ *  slowdown still shows up if enough repetitions are taken.
+ *
+ *  g++ -std=c++17 -O2 bench_compare.cpp -o bench_compare
+ *  ./bench_compare base.json new.json [--threshold PCT] [--sigma K] [--filter text]
+ *  exit status: 0 no regression, 1 regression, 2 bad input
+ */
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * a parsed JSON value. only what the benchmark writes is needed, but the parser
+ * takes any valid JSON so extra fields don't break it.
+ */
+struct json {
+	enum kind_t { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } kind = NUL;
+	double number = 0;
+	std::string string;
+	std::vector<json> array;
+	std::map<std::string, json> object;
+	const json* get(const std::string &key) const; // member of an object, null if missing
+};
+
+/*
+ * object member lookup
+ */
+const json* json::get(const std::string &key) const{
+	if(kind != OBJECT)
+		return nullptr;
+	auto it = object.find(key);
+	return it == object.end() ? nullptr : &it->second;
+}
+
+/*
+ * recursive descent over a string. errors throw std::runtime_error with the
+ * offset.
+ */
+class json_parser {
+public:
+	json_parser(const std::string &text) : t_(text), i_(0) {}
+	json parse(); // the whole document
+private:
+	json value(); // any value
+	std::string string(); // a quoted string, escapes decoded
+	void skip(); // whitespace
+	void expect(char c); // the next non-space character must be c
+	[[noreturn]] void fail(const char *what) const; // throws with the position
+	const std::string &t_; // the text
+	size_t i_; // current offset
+};
+
+json json_parser::parse(){
+	json v = value();
+	skip();
+	if(i_ != t_.size())
+		fail("trailing characters");
+	return v;
+}
+
+void json_parser::skip(){
+	while(i_ < t_.size() && isspace((unsigned char)t_[i_]))
+		i_++;
+}
+
+void json_parser::expect(char c){
+	skip();
+	if(i_ >= t_.size() || t_[i_] != c){
+		char what[32];
+		snprintf(what, sizeof(what), "expected '%c'", c);
+		fail(what);
+	}
+	i_++;
+}
+
+void json_parser::fail(const char *what) const{
+	throw std::runtime_error(std::string(what) + " at offset " + std::to_string(i_));
+}
+
+json json_parser::value(){
+	skip();
+	if(i_ >= t_.size())
+		fail("unexpected end");
+	json v;
+	const char c = t_[i_];
+	if(c == '{'){
+		v.kind = json::OBJECT;
+		i_++;
+		skip();
+		if(i_ < t_.size() && t_[i_] == '}'){
+			i_++;
+			return v;
+		}
+		for(;;){
+			skip();
+			std::string key = string();
+			expect(':');
+			v.object[key] = value();
+			skip();
+			if(i_ < t_.size() && t_[i_] == ','){
+				i_++;
+				continue;
+			}
+			expect('}');
+			return v;
+		}
+	}
+	if(c == '['){
+		v.kind = json::ARRAY;
+		i_++;
+		skip();
+		if(i_ < t_.size() && t_[i_] == ']'){
+			i_++;
+			return v;
+		}
+		for(;;){
+			v.array.push_back(value());
+			skip();
+			if(i_ < t_.size() && t_[i_] == ','){
+				i_++;
+				continue;
+			}
+			expect(']');
+			return v;
+		}
+	}
+	if(c == '"'){
+		v.kind = json::STRING;
+		v.string = string();
+		return v;
+	}
+	static const char *const words[] = { "true", "false", "null" };
+	for(int w = 0; w < 3; w++)
+		if(!t_.compare(i_, strlen(words[w]), words[w])){
+			i_ += strlen(words[w]);
+			v.kind = w < 2 ? json::BOOL : json::NUL;
+			v.number = w == 0;
+			return v;
+		}
+	const char *start = t_.c_str() + i_;
+	char *end;
+	v.number = strtod(start, &end);
+	if(end == start)
+		fail("unexpected character");
+	v.kind = json::NUMBER;
+	i_ += end - start;
+	return v;
+}
+
+/*
+ * \uXXXX escapes are kept as '?': benchmark names are ASCII
+ */
+std::string json_parser::string(){
+	if(i_ >= t_.size() || t_[i_] != '"')
+		fail("expected a string");
+	i_++;
+	std::string s;
+	while(i_ < t_.size() && t_[i_] != '"'){
+		char c = t_[i_++];
+		if(c == '\\'){
+			if(i_ >= t_.size())
+				break;
+			c = t_[i_++];
+			switch(c){
+			case 'n': c = '\n'; break;
+			case 't': c = '\t'; break;
+			case 'r': c = '\r'; break;
+			case 'b': c = '\b'; break;
+			case 'f': c = '\f'; break;
+			case 'u': i_ += 4; c = '?'; break;
+			}
+		}
+		s += c;
+	}
+	if(i_ >= t_.size())
+		fail("unterminated string");
+	i_++;
+	return s;
+}
+
+/*
+ * one benchmark's samples in one file
+ */
+struct series {
+	std::string unit;
+	std::vector<double> samples;
+	double median = 0; // of the samples, or the file's median if it has none
+	double sigma = 0; // 1.4826 * MAD, 0 without samples
+};
+
+/*
+ * median of a copy
+ */
+double median_of(std::vector<double> v){
+	std::sort(v.begin(), v.end());
+	const size_t n = v.size();
+	return n % 2 ? v[n/2] : (v[n/2-1] + v[n/2]) / 2;
+}
+
+/*
+ * reads a benchmark file into name -> series
+ */
+std::map<std::string, series> load(const char *path){
+	FILE *f = fopen(path, "rb");
+	if(!f)
+		throw std::runtime_error(std::string(path) + ": " + strerror(errno));
+	std::string text;
+	char buf[65536];
+	size_t k;
+	while((k = fread(buf, 1, sizeof(buf), f)) > 0)
+		text.append(buf, k);
+	fclose(f);
+	json doc = json_parser(text).parse();
+	const json *results = doc.get("results");
+	if(!results || results->kind != json::ARRAY)
+		throw std::runtime_error(std::string(path) + ": no \"results\" array");
+	std::map<std::string, series> out;
+	for(const json &r : results->array){
+		const json *name = r.get("name"), *unit = r.get("unit"), *median = r.get("median"), *samples = r.get("samples");
+		if(!name || name->kind != json::STRING)
+			continue;
+		series s;
+		if(unit)
+			s.unit = unit->string;
+		if(samples)
+			for(const json &x : samples->array)
+				if(x.kind == json::NUMBER)
+					s.samples.push_back(x.number);
+		if(!s.samples.empty()){
+			s.median = median_of(s.samples);
+			std::vector<double> dev;
+			for(double x : s.samples)
+				dev.push_back(std::fabs(x - s.median));
+			s.sigma = 1.4826 * median_of(dev);
+		} else if(median && median->kind == json::NUMBER)
+			s.median = median->number;
+		else
+			continue;
+		out[name->string] = s;
+	}
+	return out;
+}
+
+int main(int argc, char **argv){
+	const char *files[2] = { nullptr, nullptr };
+	double threshold = 5, sigmas = 3;
+	std::string filter;
+	int nfiles = 0;
+	for(int i = 1; i < argc; i++){
+		if(!strcmp(argv[i], "--threshold") && i + 1 < argc)
+			threshold = atof(argv[++i]);
+		else if(!strcmp(argv[i], "--sigma") && i + 1 < argc)
+			sigmas = atof(argv[++i]);
+		else if(!strcmp(argv[i], "--filter") && i + 1 < argc)
+			filter = argv[++i];
+		else if(argv[i][0] != '-' && nfiles < 2)
+			files[nfiles++] = argv[i];
+		else
+			nfiles = 3;
+	}
+	if(nfiles != 2){
+		fprintf(stderr, "usage: %s base.json new.json [--threshold PCT] [--sigma K] [--filter text]\n", argv[0]);
+		return 2;
+	}
+
+	std::map<std::string, series> base, cand;
+	try {
+		base = load(files[0]);
+		cand = load(files[1]);
+	} catch(const std::exception &e){
+		fprintf(stderr, "bench_compare: %s\n", e.what());
+		return 2;
+	}
+
+	int regressions = 0, improvements = 0, compared = 0;
+	printf("%-44s %12s %12s %9s %8s  %s\n", "benchmark", "base", "new", "change", "noise", "");
+	for(const auto &kv : base){
+		const std::string &name = kv.first;
+		if(!filter.empty() && name.find(filter) == std::string::npos)
+			continue;
+		auto it = cand.find(name);
+		if(it == cand.end()){
+			printf("%-44s %12.4g %12s\n", name.c_str(), kv.second.median, "missing");
+			continue;
+		}
+		const series &a = kv.second, &b = it->second;
+		if(a.median <= 0)
+			continue;
+		compared++;
+		// standard error of each median, combined for the difference
+		const double se_a = a.samples.empty() ? 0 : 1.2533 * a.sigma / std::sqrt((double)a.samples.size());
+		const double se_b = b.samples.empty() ? 0 : 1.2533 * b.sigma / std::sqrt((double)b.samples.size());
+		const double noise = 100 * sigmas * std::sqrt(se_a*se_a + se_b*se_b) / a.median;
+		const double change = 100 * (b.median - a.median) / a.median;
+		const double limit = std::max(threshold, noise);
+		const char *verdict = "";
+		if(change > limit){
+			verdict = "REGRESSION";
+			regressions++;
+		} else if(change < -limit){
+			verdict = "faster";
+			improvements++;
+		}
+		printf("%-44s %12.4g %12.4g %+8.2f%% %7.2f%%  %s\n", name.c_str(), a.median, b.median, change, noise, verdict);
+		if(!a.unit.empty() && a.unit != b.unit)
+			printf("    units differ: %s vs %s\n", a.unit.c_str(), b.unit.c_str());
+	}
+	for(const auto &kv : cand)
+		if(!base.count(kv.first) && (filter.empty() || kv.first.find(filter) != std::string::npos))
+			printf("%-44s %12s %12.4g\n", kv.first.c_str(), "new", kv.second.median);
+
+	printf("\n%d compared, %d regressions, %d improvements (threshold %.1f%%, %.1f sigma)\n",
+			compared, regressions, improvements, threshold, sigmas);
+	return regressions ? 1 : 0;
+}
@@ -0,0 +1,613 @@
+/*
+ * xoshiro_quality.cpp
+ *
+ *  A self-contained battery of classic statistical tests, for checking that a
+ *  new fast path (SIMD lanes, interleaving, conversions) didn't break the
+ *  quality of the output without needing TestU01 or PractRand on the machine.
+ *
+ *  Tests on the raw 64-bit stream:
+ *    monobit          proportion of one bits
+ *    runs             number of changes between consecutive bits
+ *    gap              gaps between values in [0, 1/8), chi-square
+ *    birthday         birthday spacings on the top 36 bits (Marsaglia), Poisson
+ *    matrix-rank      rank of 32x32 GF(2) matrices from the top 32 bits, chi-square
+ *    linear-comp/bN   Berlekamp-Massey linear complexity of bit N (NIST SP 800-22)
+ *  Tests on the distributions (xoshiro engines only), chi-square goodness of fit:
+ *    uniform, exponential, geometric
+ *
+ *  The stream is cut into one chunk per thread and every thread positions its
+ *  own copy of the engine at the start of its chunk with advance(), so the raw
+ *  tests see exactly the sequential stream whatever the thread count. The
+ *  statistics are counts, which are summed before computing p-values.
+ *
+ *  A p-value below 1e-10 or above 1 - 1e-10 is reported as FAIL (and the exit
+ *  status is 1), below 1e-4 or above 1 - 1e-4 as suspicious. With many tests a
+ *  few suspicious values are expected by chance; a repeatable FAIL is not.
+ *
+ *  g++ -std=c++17 -O2 -pthread -I.. xoshiro_quality.cpp -o xoshiro_quality
+ *  ./xoshiro_quality [--engine xoshiro256ss|xoshiro256p|splitmix64|interleaved4|engine_array8]
+ *                    [--values N] [--threads N] [--seed S]
+ *                    [--lc-block M] [--lc-blocks B] [--dist-values N]
+ */
+#include "../xoshiro256.hpp"
+#include "../xoshiro256_array.hpp"
+#include "../xoshiro256_interleaved.hpp"
+#include "../xoshiro256_parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * regularized upper incomplete gamma Q(a, x), series below a+1 and continued
+ * fraction above (Numerical Recipes 6.2)
+ */
+double gamma_q(double a, double x){
+	if(x <= 0)
+		return 1.0;
+	const double lg = std::lgamma(a);
+	if(x < a + 1){
+		double sum = 1.0 / a, term = sum;
+		for(int n = 1; n < 100000; n++){
+			term *= x / (a + n);
+			sum += term;
+			if(std::fabs(term) < std::fabs(sum) * 1e-16)
+				break;
+		}
+		return 1.0 - sum * std::exp(-x + a * std::log(x) - lg);
+	}
+	double b = x + 1 - a, c = 1e300, d = 1 / b, h = d;
+	for(int i = 1; i < 100000; i++){
+		const double an = -i * (i - a);
+		b += 2;
+		d = an * d + b;
+		if(std::fabs(d) < 1e-300)
+			d = 1e-300;
+		c = b + an / c;
+		if(std::fabs(c) < 1e-300)
+			c = 1e-300;
+		d = 1 / d;
+		const double del = d * c;
+		h *= del;
+		if(std::fabs(del - 1) < 1e-16)
+			break;
+	}
+	return std::exp(-x + a * std::log(x) - lg) * h;
+}
+
+/*
+ * P(chi-square with df degrees of freedom >= x)
+ */
+double chi2_p(double x, double df){
+	return gamma_q(df / 2, x / 2);
+}
+
+/*
+ * chi-square statistic and p-value from observed counts and probabilities
+ */
+double chi2_test(const std::vector<double> &observed, const std::vector<double> &prob, double *stat){
+	double total = 0, x = 0;
+	for(double o : observed)
+		total += o;
+	for(size_t i = 0; i < observed.size(); i++){
+		const double e = total * prob[i];
+		x += (observed[i] - e) * (observed[i] - e) / e;
+	}
+	*stat = x;
+	return chi2_p(x, observed.size() - 1);
+}
+
+/*
+ * two-sided p-value of a standard normal statistic
+ */
+double normal_p(double z){
+	return std::erfc(std::fabs(z) / std::sqrt(2.0));
+}
+
+/*
+ * interface of one test: feed it the stream in order, merge the per-thread
+ * copies, get a p-value
+ */
+struct test {
+	virtual ~test(){}
+	virtual std::string name() const = 0;
+	virtual void feed(const uint64_t *v, size_t n) = 0; // next n values of this thread's chunk
+	virtual void merge(const test &other) = 0; // add the counts of another thread's copy
+	virtual double p(double *stat) const = 0; // p-value, with the statistic in *stat
+	virtual std::unique_ptr<test> clone() const = 0; // fresh copy with the same parameters
+};
+
+/*
+ * monobit: the number of ones is binomial(64n, 1/2)
+ */
+struct monobit : test {
+	double ones = 0, bits = 0;
+	std::string name() const override { return "monobit"; }
+	void feed(const uint64_t *v, size_t n) override {
+		uint64_t c = 0;
+		for(size_t i = 0; i < n; i++)
+			c += __builtin_popcountll(v[i]);
+		ones += c;
+		bits += 64.0 * n;
+	}
+	void merge(const test &o) override {
+		ones += static_cast<const monobit&>(o).ones;
+		bits += static_cast<const monobit&>(o).bits;
+	}
+	double p(double *stat) const override {
+		*stat = (ones - bits / 2) / std::sqrt(bits / 4);
+		return normal_p(*stat);
+	}
+	std::unique_ptr<test> clone() const override { return std::unique_ptr<test>(new monobit); }
+};
+
+/*
+ * runs: bits read from the most significant end of each value; the number of
+ * positions where a bit differs from the previous one is binomial(pairs, 1/2).
+ * pairs that straddle two chunks are not counted.
+ */
+struct runs : test {
+	double changes = 0, pairs = 0;
+	bool have_last = false;
+	uint64_t last = 0; // low bit of the previous value
+	std::string name() const override { return "runs"; }
+	void feed(const uint64_t *v, size_t n) override {
+		uint64_t c = 0;
+		for(size_t i = 0; i < n; i++){
+			c += __builtin_popcountll((v[i] ^ (v[i] >> 1)) & 0x7fffffffffffffff);
+			if(have_last)
+				c += (last ^ (v[i] >> 63)) & 1;
+			pairs += have_last ? 64 : 63;
+			last = v[i] & 1;
+			have_last = true;
+		}
+		changes += c;
+	}
+	void merge(const test &o) override {
+		changes += static_cast<const runs&>(o).changes;
+		pairs += static_cast<const runs&>(o).pairs;
+	}
+	double p(double *stat) const override {
+		*stat = (changes - pairs / 2) / std::sqrt(pairs / 4);
+		return normal_p(*stat);
+	}
+	std::unique_ptr<test> clone() const override { return std::unique_ptr<test>(new runs); }
+};
+
+/*
+ * gap test (Knuth 3.3.2 D) with the interval [0, 1/8), i.e. the top three bits
+ * zero. gap lengths 0..T-1 and >= T, chi-square.
+ */
+struct gap : test {
+	static const int T = 48;
+	std::vector<double> counts = std::vector<double>(T + 1, 0.0);
+	long long current = -1; // values since the last hit, -1 before the first
+	std::string name() const override { return "gap"; }
+	void feed(const uint64_t *v, size_t n) override {
+		for(size_t i = 0; i < n; i++){
+			if((v[i] >> 61) == 0){
+				if(current >= 0)
+					counts[current < T ? current : T] += 1;
+				current = 0;
+			} else if(current >= 0){
+				current++;
+			}
+		}
+	}
+	void merge(const test &o) override {
+		for(int i = 0; i <= T; i++)
+			counts[i] += static_cast<const gap&>(o).counts[i];
+	}
+	double p(double *stat) const override {
+		std::vector<double> prob(T + 1);
+		const double q = 1.0 / 8;
+		for(int i = 0; i < T; i++)
+			prob[i] = q * std::pow(1 - q, i);
+		prob[T] = std::pow(1 - q, T);
+		return chi2_test(counts, prob, stat);
+	}
+	std::unique_ptr<test> clone() const override { return std::unique_ptr<test>(new gap); }
+};
+
+/*
+ * birthday spacings: m = 4096 birthdays in a year of 2^36 days from the top 36
+ * bits. the number of repeated spacings per sample is about Poisson(m^3/(4*2^36))
+ * = 1/4, so the total over all samples is Poisson(samples/4). the classic
+ * m = 512, 2^24 days makes the Poisson approximation off by about 1%, which
+ * shows up as a false failure on long streams; m^2/n is much smaller here.
+ */
+struct birthday : test {
+	static const int M = 4096;
+	std::vector<uint64_t> pending;
+	double repeats = 0, samples = 0;
+	std::string name() const override { return "birthday"; }
+	void feed(const uint64_t *v, size_t n) override {
+		for(size_t i = 0; i < n; i++){
+			pending.push_back(v[i] >> 28);
+			if(pending.size() == M){
+				std::sort(pending.begin(), pending.end());
+				std::vector<uint64_t> sp(M);
+				sp[0] = pending[0];
+				for(int j = 1; j < M; j++)
+					sp[j] = pending[j] - pending[j-1];
+				std::sort(sp.begin(), sp.end());
+				for(int j = 1; j < M; j++)
+					repeats += sp[j] == sp[j-1];
+				samples += 1;
+				pending.clear();
+			}
+		}
+	}
+	void merge(const test &o) override {
+		repeats += static_cast<const birthday&>(o).repeats;
+		samples += static_cast<const birthday&>(o).samples;
+	}
+	double p(double *stat) const override {
+		// P(X <= k) = Q(k+1, lambda), two-sided
+		const double lambda = samples / 4;
+		*stat = repeats;
+		const double lower = gamma_q(repeats + 1, lambda);
+		const double upper = repeats > 0 ? 1 - gamma_q(repeats, lambda) : 1.0;
+		return std::min(1.0, 2 * std::min(lower, upper));
+	}
+	std::unique_ptr<test> clone() const override { return std::unique_ptr<test>(new birthday); }
+};
+
+/*
+ * rank of 32x32 binary matrices, rows being the top 32 bits of 32 values.
+ * classes rank 32, 31 and <= 30 (Marsaglia, also NIST 2.5).
+ */
+struct matrix_rank : test {
+	uint32_t rows[32];
+	int filled = 0;
+	std::vector<double> counts = std::vector<double>(3, 0.0);
+	std::string name() const override { return "matrix-rank"; }
+	static int rank(uint32_t *m){
+		int r = 0;
+		for(int bit = 31; bit >= 0 && r < 32; bit--){
+			int piv = -1;
+			for(int i = r; i < 32; i++)
+				if((m[i] >> bit) & 1){
+					piv = i;
+					break;
+				}
+			if(piv < 0)
+				continue;
+			std::swap(m[r], m[piv]);
+			for(int i = 0; i < 32; i++)
+				if(i != r && ((m[i] >> bit) & 1))
+					m[i] ^= m[r];
+			r++;
+		}
+		return r;
+	}
+	void feed(const uint64_t *v, size_t n) override {
+		for(size_t i = 0; i < n; i++){
+			rows[filled++] = uint32_t(v[i] >> 32);
+			if(filled == 32){
+				const int r = rank(rows);
+				counts[r == 32 ? 0 : r == 31 ? 1 : 2] += 1;
+				filled = 0;
+			}
+		}
+	}
+	void merge(const test &o) override {
+		for(int i = 0; i < 3; i++)
+			counts[i] += static_cast<const matrix_rank&>(o).counts[i];
+	}
+	double p(double *stat) const override {
+		return chi2_test(counts, {0.2887880950866, 0.5775761901732, 0.1336357147402}, stat);
+	}
+	std::unique_ptr<test> clone() const override { return std::unique_ptr<test>(new matrix_rank); }
+};
+
+/*
+ * linear complexity of one bit position (NIST SP 800-22 2.10). each block of M
+ * bits gets its linear complexity L by Berlekamp-Massey, the deviation from the
+ * expected M/2 is binned into 7 classes, chi-square with 6 degrees of freedom.
+ * a purely linear bit, like the lowest bit of xoshiro256+, has L = 256 in every
+ * block and fails outright.
+ */
+struct linear_complexity : test {
+	int bit, M;
+	size_t max_blocks;
+	std::vector<unsigned char> pending;
+	std::vector<double> counts = std::vector<double>(7, 0.0);
+	double blocks = 0;
+	linear_complexity(int bit, int M, size_t max_blocks) : bit(bit), M(M), max_blocks(max_blocks) {}
+	std::string name() const override { return "linear-comp/b" + std::to_string(bit); }
+	static int berlekamp_massey(const unsigned char *s, int n){
+		std::vector<unsigned char> C(n + 1, 0), B(n + 1, 0), T;
+		C[0] = B[0] = 1;
+		int L = 0, m = 1;
+		for(int i = 0; i < n; i++){
+			unsigned char d = s[i];
+			for(int j = 1; j <= L; j++)
+				d ^= C[j] & s[i-j];
+			if(d == 0){
+				m++;
+			} else if(2 * L <= i){
+				T = C;
+				for(int j = 0; j + m <= n; j++)
+					C[j+m] ^= B[j];
+				L = i + 1 - L;
+				B = T;
+				m = 1;
+			} else {
+				for(int j = 0; j + m <= n; j++)
+					C[j+m] ^= B[j];
+				m++;
+			}
+		}
+		return L;
+	}
+	void feed(const uint64_t *v, size_t n) override {
+		for(size_t i = 0; i < n && blocks < max_blocks; i++){
+			pending.push_back((v[i] >> bit) & 1);
+			if((int)pending.size() == M){
+				const int L = berlekamp_massey(pending.data(), M);
+				const double sign = (M % 2) ? -1.0 : 1.0;
+				const double mu = M / 2.0 + (9.0 + (M % 2 ? 1.0 : -1.0)) / 36.0 - (M / 3.0 + 2.0 / 9.0) / std::pow(2.0, M);
+				const double t = sign * (L - mu) + 2.0 / 9.0;
+				const int k = t <= -2.5 ? 0 : t <= -1.5 ? 1 : t <= -0.5 ? 2 : t <= 0.5 ? 3 : t <= 1.5 ? 4 : t <= 2.5 ? 5 : 6;
+				counts[k] += 1;
+				blocks += 1;
+				pending.clear();
+			}
+		}
+	}
+	void merge(const test &o) override {
+		for(int i = 0; i < 7; i++)
+			counts[i] += static_cast<const linear_complexity&>(o).counts[i];
+		blocks += static_cast<const linear_complexity&>(o).blocks;
+	}
+	double p(double *stat) const override {
+		return chi2_test(counts, {0.010417, 0.03125, 0.125, 0.5, 0.25, 0.0625, 0.020833}, stat);
+	}
+	std::unique_ptr<test> clone() const override {
+		return std::unique_ptr<test>(new linear_complexity(bit, M, max_blocks));
+	}
+};
+
+/*
+ * a stream of 64-bit values that can start at any position
+ */
+struct source {
+	virtual ~source(){}
+	virtual void fill(uint64_t *out, size_t n) = 0;
+};
+
+/*
+ * xoshiro256** or xoshiro256+, positioned with advance()
+ */
+template <class Engine>
+struct engine_source : source {
+	Engine e;
+	engine_source(uint64_t seed, uint64_t offset){
+		seed_engine(e, seed);
+		e.advance(offset);
+	}
+	void fill(uint64_t *out, size_t n) override {
+		for(size_t i = 0; i < n; i++)
+			out[i] = e.Engine::operator()();
+	}
+};
+
+/*
+ * splitmix64, positioned with discard()
+ */
+struct splitmix_source : source {
+	splitmix64 e;
+	splitmix_source(uint64_t seed, uint64_t offset) : e(seed) { e.discard(offset); }
+	void fill(uint64_t *out, size_t n) override { e.fill(out, n); }
+};
+
+/*
+ * interleaved<4>: jumps and advance commute, so advancing the base by offset/4
+ * before splitting it into streams starts the output at offset
+ */
+struct interleaved_source : source {
+	std::unique_ptr<interleaved<4> > e;
+	interleaved_source(uint64_t seed, uint64_t offset){
+		xoshiro256ss base;
+		seed_engine(base, seed);
+		base.advance(offset / 4);
+		e.reset(new interleaved<4>(base));
+	}
+	void fill(uint64_t *out, size_t n) override { e->fill(out, n); }
+};
+
+/*
+ * engine_array with 8 jump-separated lanes, read one step at a time
+ */
+struct array_source : source {
+	std::unique_ptr<engine_array> e;
+	uint64_t buf[8];
+	int pos = 8;
+	array_source(uint64_t seed, uint64_t offset){
+		xoshiro256ss base;
+		seed_engine(base, seed);
+		base.advance(offset / 8);
+		e.reset(new engine_array(8, base));
+	}
+	void fill(uint64_t *out, size_t n) override {
+		for(size_t i = 0; i < n; i++){
+			if(pos == 8){
+				e->next(buf);
+				pos = 0;
+			}
+			out[i] = buf[pos++];
+		}
+	}
+};
+
+/*
+ * builds the source for an engine name, null if unknown
+ */
+std::unique_ptr<source> make_source(const std::string &engine, uint64_t seed, uint64_t offset){
+	if(engine == "xoshiro256ss")
+		return std::unique_ptr<source>(new engine_source<xoshiro256ss>(seed, offset));
+	if(engine == "xoshiro256p")
+		return std::unique_ptr<source>(new engine_source<xoshiro256p>(seed, offset));
+	if(engine == "splitmix64")
+		return std::unique_ptr<source>(new splitmix_source(seed, offset));
+	if(engine == "interleaved4")
+		return std::unique_ptr<source>(new interleaved_source(seed, offset));
+	if(engine == "engine_array8")
+		return std::unique_ptr<source>(new array_source(seed, offset));
+	return nullptr;
+}
+
+/*
+ * chi-square fit of the three distribution functions. each thread uses the
+ * engine jumped once per thread index.
+ */
+struct dist_counts {
+	static const int BINS = 1000, GEO = 40;
+	std::vector<double> uni = std::vector<double>(BINS, 0.0);
+	std::vector<double> expo = std::vector<double>(BINS, 0.0);
+	std::vector<double> geo = std::vector<double>(GEO + 1, 0.0);
+	void run(xoshiro256ss &e, size_t n){
+		for(size_t i = 0; i < n; i++){
+			const double u = e.uniform(0.0, 1.0);
+			uni[std::min(int(u * BINS), BINS - 1)] += 1;
+			const double x = e.exponential(1.0);
+			expo[std::min(int((1 - std::exp(-x)) * BINS), BINS - 1)] += 1;
+			const int g = e.geometric(0.2);
+			geo[g < GEO ? g : GEO] += 1;
+		}
+	}
+	void merge(const dist_counts &o){
+		for(int i = 0; i < BINS; i++){
+			uni[i] += o.uni[i];
+			expo[i] += o.expo[i];
+		}
+		for(int i = 0; i <= GEO; i++)
+			geo[i] += o.geo[i];
+	}
+};
+
+int main(int argc, char **argv){
+	std::string engine = "xoshiro256ss";
+	uint64_t values = UINT64_C(1) << 26, seed = 1, dist_values = 1 << 22;
+	unsigned threads = std::thread::hardware_concurrency();
+	int lc_block = 1000;
+	size_t lc_blocks = 500;
+	for(int i = 1; i < argc; i++){
+		const bool more = i + 1 < argc;
+		if(!strcmp(argv[i], "--engine") && more)
+			engine = argv[++i];
+		else if(!strcmp(argv[i], "--values") && more)
+			values = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--threads") && more)
+			threads = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--seed") && more)
+			seed = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--lc-block") && more)
+			lc_block = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--lc-blocks") && more)
+			lc_blocks = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--dist-values") && more)
+			dist_values = strtoull(argv[++i], nullptr, 0);
+		else {
+			fprintf(stderr, "usage: %s [--engine name] [--values N] [--threads N] [--seed S]"
+					" [--lc-block M] [--lc-blocks B] [--dist-values N]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(threads == 0)
+		threads = 1;
+	if(!make_source(engine, seed, 0)){
+		fprintf(stderr, "unknown engine %s\n", engine.c_str());
+		return 2;
+	}
+
+	std::vector<std::unique_ptr<test> > battery;
+	battery.emplace_back(new monobit);
+	battery.emplace_back(new runs);
+	battery.emplace_back(new gap);
+	battery.emplace_back(new birthday);
+	battery.emplace_back(new matrix_rank);
+	for(int bit : {0, 1, 2, 63})
+		battery.emplace_back(new linear_complexity(bit, lc_block, (lc_blocks + threads - 1) / threads));
+
+	// chunks are multiples of 64 values so the lane sources split evenly
+	const uint64_t chunk = (values / threads + 63) / 64 * 64;
+	std::vector<std::vector<std::unique_ptr<test> > > local(threads);
+	std::vector<dist_counts> dists(threads);
+	const bool do_dist = engine == "xoshiro256ss" || engine == "xoshiro256p";
+	std::vector<std::thread> pool;
+	for(unsigned t = 0; t < threads; t++){
+		for(auto &b : battery)
+			local[t].push_back(b->clone());
+		pool.emplace_back([&, t]{
+			const uint64_t start = t * chunk;
+			const uint64_t end = std::min<uint64_t>(values, start + chunk);
+			if(start < end){
+				std::unique_ptr<source> src = make_source(engine, seed, start);
+				std::vector<uint64_t> buf(1 << 16);
+				for(uint64_t pos = start; pos < end; pos += buf.size()){
+					const size_t n = std::min<uint64_t>(buf.size(), end - pos);
+					src->fill(buf.data(), n);
+					for(auto &x : local[t])
+						x->feed(buf.data(), n);
+				}
+			}
+			if(do_dist){
+				std::unique_ptr<xoshiro256ss> e(engine == "xoshiro256p" ? new xoshiro256p : new xoshiro256ss);
+				seed_engine(*e, seed);
+				e->long_jump();
+				e->jump(t);
+				dists[t].run(*e, dist_values / threads);
+			}
+		});
+	}
+	for(auto &th : pool)
+		th.join();
+	for(unsigned t = 1; t < threads; t++){
+		for(size_t i = 0; i < battery.size(); i++)
+			local[0][i]->merge(*local[t][i]);
+		dists[0].merge(dists[t]);
+	}
+
+	printf("engine %s, %llu values, seed %llu, %u threads\n", engine.c_str(),
+			(unsigned long long)values, (unsigned long long)seed, threads);
+	printf("%-18s %14s %12s\n", "test", "statistic", "p-value");
+	int failures = 0;
+	auto report = [&](const std::string &name, double stat, double p){
+		const char *flag = "";
+		if(p < 1e-10 || p > 1 - 1e-10){
+			flag = "  FAIL";
+			failures++;
+		} else if(p < 1e-4 || p > 1 - 1e-4){
+			flag = "  suspicious";
+		}
+		printf("%-18s %14.4f %12.6g%s\n", name.c_str(), stat, p, flag);
+	};
+	for(auto &x : local[0]){
+		double stat;
+		const double p = x->p(&stat);
+		report(x->name(), stat, p);
+	}
+	if(do_dist){
+		const dist_counts &d = dists[0];
+		double stat;
+		std::vector<double> flat(dist_counts::BINS, 1.0 / dist_counts::BINS);
+		double p = chi2_test(d.uni, flat, &stat);
+		report("uniform", stat, p);
+		p = chi2_test(d.expo, flat, &stat);
+		report("exponential", stat, p);
+		std::vector<double> gp(dist_counts::GEO + 1);
+		for(int i = 0; i < dist_counts::GEO; i++)
+			gp[i] = 0.2 * std::pow(0.8, i);
+		gp[dist_counts::GEO] = std::pow(0.8, dist_counts::GEO);
+		p = chi2_test(d.geo, gp, &stat);
+		report("geometric", stat, p);
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,1877 @@
+/*
+ * xoshiro_selfcheck.cpp
+ *
+ *  Checks every code path against the reference algorithms, so a new fast path
+ *  can be trusted before it is switched on in production.
+ *
+ *    known answers   first outputs of splitmix64 and every engine from fixed
+ *                    seeds, and the states after jump() and long_jump(), all
+ *                    produced by the reference C code
+ *    reference       the engines against a copy of the reference C code (the
+ *                    algorithms quoted in xoshiro256_core.hpp, xoshiro128.hpp,
+ *                    xoshiro512.hpp and xoroshiro1024.hpp) from random states
+ *    jump-ahead      jump(n), long_jump(n) and advance(n) against n single
+ *                    jumps or steps for every family, and split() against
+ *                    its definition
+ *    reverse         previous() against the values drawn forward, retreat(n)
+ *                    against n previous() calls and advance(n), and
+ *                    engine_iterator walked both ways
+ *    replay          replay_log states at random positions against the draws
+ *                    themselves, through a dump and parse; with XOSHIRO_REPLAY
+ *                    also the automatic checkpoints across advance, retreat
+ *                    and jumps. for one engine of every family
+ *    bulk paths      splitmix64 fill/at/discard, engine_array, interleaved<N>,
+ *                    xoshiro128_lanes<L> fill and fill_uniform,
+ *                    parallel_fill, per_thread_engines, engine_pool task
+ *                    streams and checkouts across threads, random_feeder and the range views against
+ *                    repeated scalar calls, with random sizes, seeds and
+ *                    chunking; engine_array, interleaved<N> and the Engine
+ *                    templates also with xoshiro512 and xoroshiro1024
+ *    shared streams  stream_registry slots against the base engine after that
+ *                    many long jumps, two registries sharing one file, and an
+ *                    attached engine moved in a forked child (POSIX only)
+ *    instrument      with XOSHIRO_INSTRUMENT, the counts of labeled engines
+ *                    while they live and of unlabeled ones once destroyed
+ *    formatting      the binary, hex and base64 formatters against printf and a
+ *                    plain encoder, their parsers, and engine_array state dumps
+ *    constexpr       the compile-time engines of xoshiro256_constexpr.hpp
+ *                    against the known answers in static_asserts, and every
+ *                    one against its runtime engine, seeding and uniform() at
+ *                    run time; bounded() against a 128-bit multiply
+ *
+ *  The random cases are drawn from std::mt19937_64 so a bug in this library
+ *  can't hide itself. The exit status is 1 if anything differs, and the first
+ *  mismatch of every check is printed.
+ *
+ *  g++ -std=c++20 -O2 -pthread -I.. xoshiro_selfcheck.cpp -o xoshiro_selfcheck
+ *  ./xoshiro_selfcheck [--iterations N] [--seed S]
+ *  (with -std=c++17 everything but the range views is checked)
+ */
+#include "../xoroshiro1024.hpp"
+#include "../xoshiro128.hpp"
+#include "../xoshiro128_lanes.hpp"
+#include "../xoshiro256.hpp"
+#include "../xoshiro256_array.hpp"
+#include "../xoshiro256_constexpr.hpp"
+#include "../xoshiro256_feeder.hpp"
+#include "../xoshiro256_instrument.hpp"
+#include "../xoshiro256_interleaved.hpp"
+#include "../xoshiro256_io.hpp"
+#include "../xoshiro256_iterator.hpp"
+#include "../xoshiro256_parallel.hpp"
+#include "../xoshiro256_pool.hpp"
+#include "../xoshiro256_ranges.hpp"
+#include "../xoshiro256_replay.hpp"
+#include "../xoshiro512.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include "../xoshiro256_shm.hpp"
+#include <sys/wait.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace reference {
+
+/*
+ * the reference C code, kept apart from the library so the two can be compared
+ */
+static inline uint64_t rotl(const uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+uint64_t splitmix64_next(uint64_t &x) {
+	uint64_t z = (x += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+uint64_t starstar_next(uint64_t *s) {
+	const uint64_t result = rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+	return result;
+}
+
+uint64_t plus_next(uint64_t *s) {
+	const uint64_t result = s[0] + s[3];
+	const uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+	return result;
+}
+
+static const uint64_t JUMP[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+static const uint64_t LONG_JUMP[] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+
+void jump(uint64_t *s, const uint64_t *J) {
+	uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	for(int i = 0; i < 4; i++)
+		for(int b = 0; b < 64; b++) {
+			if (J[i] & UINT64_C(1) << b) {
+				s0 ^= s[0];
+				s1 ^= s[1];
+				s2 ^= s[2];
+				s3 ^= s[3];
+			}
+			starstar_next(s);
+		}
+	s[0] = s0;
+	s[1] = s1;
+	s[2] = s2;
+	s[3] = s3;
+}
+
+static inline uint32_t rotl32(const uint32_t x, int k) {
+	return (x << k) | (x >> (32 - k));
+}
+
+uint32_t starstar128_next(uint32_t *s) {
+	const uint32_t result = rotl32(s[1] * 5, 7) * 9;
+	const uint32_t t = s[1] << 9;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl32(s[3], 11);
+	return result;
+}
+
+uint32_t plus128_next(uint32_t *s) {
+	const uint32_t result = s[0] + s[3];
+	const uint32_t t = s[1] << 9;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl32(s[3], 11);
+	return result;
+}
+
+uint32_t plusplus128_next(uint32_t *s) {
+	const uint32_t result = rotl32(s[0] + s[3], 7) + s[0];
+	const uint32_t t = s[1] << 9;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl32(s[3], 11);
+	return result;
+}
+
+static const uint32_t JUMP128[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+static const uint32_t LONG_JUMP128[] = { 0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662 };
+
+void jump128(uint32_t *s, const uint32_t *J) {
+	uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	for(int i = 0; i < 4; i++)
+		for(int b = 0; b < 32; b++) {
+			if (J[i] & UINT32_C(1) << b) {
+				s0 ^= s[0];
+				s1 ^= s[1];
+				s2 ^= s[2];
+				s3 ^= s[3];
+			}
+			starstar128_next(s);
+		}
+	s[0] = s0;
+	s[1] = s1;
+	s[2] = s2;
+	s[3] = s3;
+}
+
+uint64_t starstar512_next(uint64_t *s) {
+	const uint64_t result = rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 11;
+	s[2] ^= s[0];
+	s[5] ^= s[1];
+	s[1] ^= s[2];
+	s[7] ^= s[3];
+	s[3] ^= s[4];
+	s[4] ^= s[5];
+	s[0] ^= s[6];
+	s[6] ^= s[7];
+	s[6] ^= t;
+	s[7] = rotl(s[7], 21);
+	return result;
+}
+
+uint64_t plus512_next(uint64_t *s) {
+	const uint64_t result = s[0] + s[2];
+	starstar512_next(s);
+	return result;
+}
+
+uint64_t plusplus512_next(uint64_t *s) {
+	const uint64_t result = rotl(s[0] + s[2], 17) + s[2];
+	starstar512_next(s);
+	return result;
+}
+
+static const uint64_t JUMP512[] = { 0x33ed89b6e7a353f9, 0x760083d7955323be, 0x2837f2fbb5f22fae, 0x4b8c5674d309511c,
+		0xb11ac47a7ba28c25, 0xf1be7667092bcc1c, 0x53851efdb6df0aaf, 0x1ebbc8b23eaf25db };
+static const uint64_t LONG_JUMP512[] = { 0x11467fef8f921d28, 0xa2a819f2e79c8ea8, 0xa8299fc284b3959a, 0xb4d347340ca63ee1,
+		0x1cb0940bedbff6ce, 0xd956c5c4fa1f8e17, 0x915e38fd4eda93bc, 0x5b3ccdfa5d7daca5 };
+
+void jump512(uint64_t *s, const uint64_t *J) {
+	uint64_t t[8] = { 0 };
+	for(int i = 0; i < 8; i++)
+		for(int b = 0; b < 64; b++) {
+			if (J[i] & UINT64_C(1) << b)
+				for(int w = 0; w < 8; w++)
+					t[w] ^= s[w];
+			starstar512_next(s);
+		}
+	memcpy(s, t, sizeof(t));
+}
+
+// the reference keeps p in a global; here it is passed along
+uint64_t starstar1024_next(uint64_t *s, int &p) {
+	const int q = p;
+	const uint64_t s0 = s[p = (p + 1) & 15];
+	uint64_t s15 = s[q];
+	const uint64_t result = rotl(s0 * 5, 7) * 9;
+	s15 ^= s0;
+	s[q] = rotl(s0, 25) ^ s15 ^ (s15 << 27);
+	s[p] = rotl(s15, 36);
+	return result;
+}
+
+uint64_t star1024_next(uint64_t *s, int &p) {
+	const uint64_t result = s[(p + 1) & 15] * 0x9e3779b97f4a7c13;
+	starstar1024_next(s, p);
+	return result;
+}
+
+static const uint64_t JUMP1024[] = { 0x931197d8e3177f17, 0xb59422e0b9138c5f, 0xf06a6afb49d668bb, 0xacb8a6412c8a1401,
+		0x12304ec85f0b3468, 0xb7dfe7079209891e, 0x405b7eec77d9eb14, 0x34ead68280c44e4a,
+		0xe0e4ba3e0ac9e366, 0x8f46eda8348905b7, 0x328bf4dbad90d6ff, 0xc8fd6fb31c9effc3,
+		0xe899d452d4b67652, 0x45f387286ade3205, 0x03864f454a8920bd, 0xa68fa28725b1b384 };
+static const uint64_t LONG_JUMP1024[] = { 0x7374156360bbf00f, 0x4630c2efa3b3c1f6, 0x6654183a892786b1, 0x94f7bfcbfb0f1661,
+		0x27d8243d3d13eb2d, 0x9701730f3dfb300f, 0x2f293baae6f604ad, 0xa661831cb60cd8b6,
+		0x68280c77d9fe008c, 0x50554160f5ba9459, 0x2fc20b17ec7b2a9a, 0x49189bbdc8ec9f8f,
+		0x92a65bca41852cc1, 0xf46820dd0509c12a, 0x52b00c35fbf92185, 0x1e5b3b7f589e03c1 };
+
+void jump1024(uint64_t *s, int &p, const uint64_t *J) {
+	uint64_t t[16] = { 0 };
+	for(int i = 0; i < 16; i++)
+		for(int b = 0; b < 64; b++) {
+			if (J[i] & UINT64_C(1) << b)
+				for(int j = 0; j < 16; j++)
+					t[j] ^= s[(j + p) & 15];
+			starstar1024_next(s, p);
+		}
+	for(int i = 0; i < 16; i++)
+		s[(i + p) & 15] = t[i];
+}
+
+} // namespace reference
+
+/*
+ * counts checks and failures, and prints the first failure of every check
+ */
+struct checker {
+	std::map<std::string, std::pair<uint64_t, uint64_t> > counts; // name -> checks, failures
+
+	/*
+	 * records one comparison. detail is only formatted when it is printed.
+	 */
+	void expect(const std::string &name, bool ok, const char *what = "", uint64_t got = 0, uint64_t want = 0){
+		std::pair<uint64_t, uint64_t> &c = counts[name];
+		c.first++;
+		if(ok)
+			return;
+		if(c.second++ == 0)
+			printf("  FAIL %s: %s got 0x%016llx, expected 0x%016llx\n", name.c_str(), what,
+					(unsigned long long)got, (unsigned long long)want);
+	}
+
+	/*
+	 * compares two sequences, counting them as one check
+	 */
+	void expect_equal(const std::string &name, const uint64_t *got, const uint64_t *want, size_t n, const char *what = ""){
+		for(size_t i = 0; i < n; i++)
+			if(got[i] != want[i]){
+				char buf[96];
+				snprintf(buf, sizeof(buf), "%s[%zu]", what, i);
+				expect(name, false, buf, got[i], want[i]);
+				return;
+			}
+		expect(name, true);
+	}
+
+	/*
+	 * compares the states of two engines
+	 */
+	void expect_state(const std::string &name, const xoshiro256ss &got, const uint64_t *want){
+		expect_equal(name, got.s, want, 4, "s");
+	}
+
+	/*
+	 * compares the states of two 32-bit engines
+	 */
+	void expect_state(const std::string &name, const xoshiro128ss &got, const uint32_t *want){
+		const uint64_t g[] = { got.s[0], got.s[1], got.s[2], got.s[3] };
+		const uint64_t w[] = { want[0], want[1], want[2], want[3] };
+		expect_equal(name, g, w, 4, "s");
+	}
+
+	/*
+	 * compares the states of two xoshiro512 engines
+	 */
+	void expect_state(const std::string &name, const xoshiro512ss &got, const uint64_t *want){
+		expect_equal(name, got.s, want, 8, "s");
+	}
+
+	/*
+	 * compares the states of two xoroshiro1024 engines, ring start included
+	 */
+	void expect_state(const std::string &name, const xoroshiro1024ss &got, const uint64_t *want, int p){
+		expect(name, got.p == p, "p", got.p, p);
+		expect_equal(name, got.s, want, 16, "s");
+	}
+
+	/*
+	 * prints the table and returns the number of failed checks
+	 */
+	uint64_t report() const{
+		uint64_t failed = 0;
+		printf("\n%-48s %10s %10s\n", "check", "cases", "failures");
+		for(const auto &kv : counts){
+			printf("%-48s %10llu %10llu  %s\n", kv.first.c_str(), (unsigned long long)kv.second.first,
+					(unsigned long long)kv.second.second, kv.second.second ? "FAIL" : "ok");
+			failed += kv.second.second;
+		}
+		return failed;
+	}
+};
+
+/*
+ * a random nonzero state
+ */
+void random_state(std::mt19937_64 &r, uint64_t *s){
+	do {
+		for(int i = 0; i < 4; i++)
+			s[i] = r();
+	} while((s[0] | s[1] | s[2] | s[3]) == 0);
+}
+
+/*
+ * a random nonzero state of any size
+ */
+void random_state(std::mt19937_64 &r, uint64_t *s, int words){
+	uint64_t any;
+	do {
+		any = 0;
+		for(int i = 0; i < words; i++)
+			any |= s[i] = r();
+	} while(any == 0);
+}
+
+/*
+ * a random nonzero 32-bit state
+ */
+void random_state(std::mt19937_64 &r, uint32_t *s){
+	do {
+		for(int i = 0; i < 4; i++)
+			s[i] = (uint32_t)r();
+	} while((s[0] | s[1] | s[2] | s[3]) == 0);
+}
+
+/*
+ * an engine of any family from a random nonzero state
+ */
+template <class Engine>
+Engine random_engine(std::mt19937_64 &r){
+	typename Engine::word w[Engine::family::words];
+	uint64_t any;
+	do {
+		any = 0;
+		for(unsigned i = 0; i < Engine::family::words; i++)
+			any |= w[i] = (typename Engine::word)r();
+	} while(any == 0);
+	return Engine(w);
+}
+
+/*
+ * an engine's words in logical order, widened, so states of any family compare
+ * with expect_equal
+ */
+template <class Engine>
+std::vector<uint64_t> state_of(const Engine &e){
+	typename Engine::word w[Engine::family::words];
+	e.get_state(w);
+	return std::vector<uint64_t>(w, w + Engine::family::words);
+}
+
+/*
+ * fixed vectors from the reference implementations
+ */
+void known_answers(checker &c){
+	const uint64_t SM0[] = { 0xe220a8397b1dcdaf, 0x6e789e6aa1b965f4, 0x06c45d188009454f, 0xf88bb8a8724c81ec };
+	const uint64_t SM1234567[] = { 0x599ed017fb08fc85, 0x2c73f08458540fa5, 0x883ebce5a3f27c77, 0x3fbef740e9177b3f };
+	const uint64_t SS[] = { 0x0000000000002d00, 0x0000000000000000, 0x000000005a007080,
+			0x10e0000000009d80, 0x10e0b61ce1009d80, 0x0870021ce143ad00 };
+	const uint64_t P[] = { 0x0000000000000005, 0x0000c00000000007, 0x0000c00018000007,
+			0x8001600018040302, 0x8061900024040305, 0xc0617014120f0583 };
+	const uint64_t JUMPED[] = { 0x8c7a153956b5f3d1, 0x701f1a713401d85e, 0x6527f66a65469085, 0x8386b786c4408050 };
+	const uint64_t LONG_JUMPED[] = { 0x096a8eb71295a400, 0xdbf84991e50f4516, 0x534ee745810d2a0e, 0x31655ca1a2215bf1 };
+	uint64_t out[6];
+
+	splitmix64 sm0(0), sm1(1234567);
+	for(int i = 0; i < 4; i++)
+		out[i] = sm0();
+	c.expect_equal("kat/splitmix64 seed 0", out, SM0, 4);
+	for(int i = 0; i < 4; i++)
+		out[i] = sm1();
+	c.expect_equal("kat/splitmix64 seed 1234567", out, SM1234567, 4);
+
+	xoshiro256ss ss(1, 2, 3, 4);
+	for(int i = 0; i < 6; i++)
+		out[i] = ss();
+	c.expect_equal("kat/xoshiro256ss {1,2,3,4}", out, SS, 6);
+	xoshiro256p p(1, 2, 3, 4);
+	for(int i = 0; i < 6; i++)
+		out[i] = p();
+	c.expect_equal("kat/xoshiro256p {1,2,3,4}", out, P, 6);
+
+	xoshiro256ss j(1, 2, 3, 4), lj(1, 2, 3, 4);
+	j.jump();
+	lj.long_jump();
+	c.expect_state("kat/jump {1,2,3,4}", j, JUMPED);
+	c.expect_state("kat/long_jump {1,2,3,4}", lj, LONG_JUMPED);
+	xoshiro256p pj(1, 2, 3, 4);
+	pj.jump();
+	c.expect_state("kat/jump {1,2,3,4}", pj, JUMPED);
+
+	const uint64_t SS128[] = { 0x00002d00, 0x00000000, 0x005a7080, 0x04389d80, 0x79199d9b, 0x61963b24 };
+	const uint64_t P128[] = { 0x00000005, 0x00003007, 0x01803007, 0x01a05c0e, 0x0260840a, 0x43f87e19 };
+	const uint64_t PP128[] = { 0x00000281, 0x00180387, 0xc0183387, 0xd1ae3b02, 0x31e2310a, 0xfd275ab0 };
+	const uint32_t JUMPED128[] = { 0xa9765206, 0x797aa168, 0x5b62e331, 0x02abd971 };
+	const uint32_t LONG_JUMPED128[] = { 0x6014af26, 0x7eb5a852, 0x399fbba1, 0xbe5ebfce };
+
+	xoshiro128ss ss128(1, 2, 3, 4);
+	for(int i = 0; i < 6; i++)
+		out[i] = ss128();
+	c.expect_equal("kat/xoshiro128ss {1,2,3,4}", out, SS128, 6);
+	xoshiro128p p128(1, 2, 3, 4);
+	for(int i = 0; i < 6; i++)
+		out[i] = p128();
+	c.expect_equal("kat/xoshiro128p {1,2,3,4}", out, P128, 6);
+	xoshiro128pp pp128(1, 2, 3, 4);
+	for(int i = 0; i < 6; i++)
+		out[i] = pp128();
+	c.expect_equal("kat/xoshiro128pp {1,2,3,4}", out, PP128, 6);
+
+	xoshiro128ss j128(1, 2, 3, 4), lj128(1, 2, 3, 4);
+	j128.jump();
+	lj128.long_jump();
+	c.expect_state("kat/xoshiro128 jump {1,2,3,4}", j128, JUMPED128);
+	c.expect_state("kat/xoshiro128 long_jump {1,2,3,4}", lj128, LONG_JUMPED128);
+
+	const uint64_t SEED8[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	const uint64_t SEED16[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+	const uint64_t SS512[] = { 0x0000000000002d00, 0x0000000000000000, 0x0000000000005a00,
+			0x0000000001692480, 0x00000021c0004380, 0x04380002d2d00000 };
+	const uint64_t P512[] = { 0x0000000000000004, 0x0000000000000008, 0x0000000000001011,
+			0x0000000001801010, 0x0000300001a0401b, 0x0000340002a08807 };
+	const uint64_t PP512[] = { 0x0000000000080003, 0x0000000000100002, 0x0000000020220004,
+			0x0000030020201009, 0x6000034081b6100e, 0x6800354111ae2003 };
+	const uint64_t JUMPED512[] = { 0x362505100e9f7d7c, 0x63fab37a35129580, 0xac6a00ec8dc639a2, 0xded17b8d82675240,
+			0x72579e2a291b4b08, 0xc67538b8bc1fb96d, 0x381684e2d1d18563, 0xcf5958f38a851658 };
+	const uint64_t LONG_JUMPED512[] = { 0xa766c0ec8f9c96c5, 0x0cf7521dd61419a3, 0x4b0e7c88390a9998, 0x39193514ee3f4af7,
+			0xe6877a13751bef91, 0x698aa22d907d105b, 0xbe534af9e5fc065e, 0xdbbe821716eea766 };
+
+	xoshiro512ss ss512(SEED8);
+	for(int i = 0; i < 6; i++)
+		out[i] = ss512();
+	c.expect_equal("kat/xoshiro512ss {1..8}", out, SS512, 6);
+	xoshiro512p p512(SEED8);
+	for(int i = 0; i < 6; i++)
+		out[i] = p512();
+	c.expect_equal("kat/xoshiro512p {1..8}", out, P512, 6);
+	xoshiro512pp pp512(SEED8);
+	for(int i = 0; i < 6; i++)
+		out[i] = pp512();
+	c.expect_equal("kat/xoshiro512pp {1..8}", out, PP512, 6);
+
+	xoshiro512ss j512(SEED8), lj512(SEED8);
+	j512.jump();
+	lj512.long_jump();
+	c.expect_state("kat/xoshiro512 jump {1..8}", j512, JUMPED512);
+	c.expect_state("kat/xoshiro512 long_jump {1..8}", lj512, LONG_JUMPED512);
+
+	// the jump starts three steps in, so the ring doesn't start at 0
+	const uint64_t SS1024[] = { 0x0000000000002d00, 0x0000000000004380, 0x0000000000005a00,
+			0x0000000000007080, 0x0000000000008700, 0x0000000000009d80 };
+	const uint64_t S1024[] = { 0x3c6ef372fe94f826, 0xdaa66d2c7ddf7439, 0x78dde6e5fd29f04c,
+			0x1715609f7c746c5f, 0xb54cda58fbbee872, 0x538454127b096485 };
+	const uint64_t JUMPED1024[] = { 0x4fa3b2741fc42080, 0x33e041b77fbc7b72, 0x72b76f46b4279c4e, 0x5108cca8505952de,
+			0x3886f9ea1c247083, 0x76a77691730fc2c2, 0xee8a8c1a93db7368, 0xc5d9af27ea1a5755,
+			0x2177c95f2dcf61d7, 0x992b4f3ede751ca1, 0x9ff47ca175f7f1fd, 0x878e718f6ed3e62b,
+			0x9004c4d49bc91558, 0xf9ac6906e061e830, 0x0c9d3c7cd58e27e1, 0xaacad46b3a656e12 };
+	const uint64_t LONG_JUMPED1024[] = { 0x7d6f93b08a9d7eb0, 0x1c877772bb4351e6, 0xe09936c240c3e9f7, 0xf71ae0b2c4897c5d,
+			0xe59f6a792b081418, 0xdbf0e03b9ad6d1d8, 0x9e5126119fbc42b9, 0x330b5caba3850874,
+			0x3bde82dc2d23df32, 0x719b11447aaef843, 0x4f537fcb3e77643a, 0x8d83cd69a6d93c86,
+			0x6a43dda21bada305, 0x5400ab098194aae5, 0x6eee519c2eef83b5, 0x19f654e339905226 };
+
+	xoroshiro1024ss ss1024(SEED16);
+	for(int i = 0; i < 6; i++)
+		out[i] = ss1024();
+	c.expect_equal("kat/xoroshiro1024ss {1..16}", out, SS1024, 6);
+	xoroshiro1024s s1024(SEED16);
+	for(int i = 0; i < 6; i++)
+		out[i] = s1024();
+	c.expect_equal("kat/xoroshiro1024s {1..16}", out, S1024, 6);
+
+	xoroshiro1024ss j1024(SEED16), lj1024(SEED16);
+	for(int i = 0; i < 3; i++)
+		j1024();
+	j1024.jump();
+	lj1024.long_jump();
+	c.expect_state("kat/xoroshiro1024 jump {1..16}", j1024, JUMPED1024, 3);
+	c.expect_state("kat/xoroshiro1024 long_jump {1..16}", lj1024, LONG_JUMPED1024, 0);
+}
+
+/*
+ * the engines against the reference code from random states
+ */
+void against_reference(checker &c, std::mt19937_64 &r, int iterations){
+	for(int it = 0; it < iterations; it++){
+		uint64_t ref[4];
+		random_state(r, ref);
+		xoshiro256ss ss(ref[0], ref[1], ref[2], ref[3]);
+		xoshiro256p p(ref[0], ref[1], ref[2], ref[3]);
+		uint64_t pref[4] = { ref[0], ref[1], ref[2], ref[3] };
+		bool ok_ss = true, ok_p = true;
+		for(int i = 0; i < 1000; i++){
+			ok_ss &= ss() == reference::starstar_next(ref);
+			ok_p &= p() == reference::plus_next(pref);
+		}
+		c.expect("reference/xoshiro256ss 1000 values", ok_ss);
+		c.expect("reference/xoshiro256p 1000 values", ok_p);
+
+		reference::jump(ref, reference::JUMP);
+		ss.jump();
+		c.expect_state("reference/jump", ss, ref);
+		reference::jump(ref, reference::LONG_JUMP);
+		ss.long_jump();
+		c.expect_state("reference/long_jump", ss, ref);
+
+		uint64_t x = r(), y = x;
+		splitmix64 sm(x);
+		bool ok_sm = true;
+		for(int i = 0; i < 100; i++)
+			ok_sm &= sm() == reference::splitmix64_next(y);
+		c.expect("reference/splitmix64 100 values", ok_sm);
+	}
+}
+
+/*
+ * the 32-bit engines against the reference code, their jump-ahead against
+ * walking there, and uniform() against its definition
+ */
+void xoshiro128_family(checker &c, std::mt19937_64 &r, int iterations){
+	for(int it = 0; it < iterations; it++){
+		uint32_t ref[4];
+		random_state(r, ref);
+		xoshiro128ss ss(ref[0], ref[1], ref[2], ref[3]);
+		xoshiro128p p(ref[0], ref[1], ref[2], ref[3]);
+		xoshiro128pp pp(ref[0], ref[1], ref[2], ref[3]);
+		uint32_t pref[4] = { ref[0], ref[1], ref[2], ref[3] };
+		uint32_t ppref[4] = { ref[0], ref[1], ref[2], ref[3] };
+		bool ok_ss = true, ok_p = true, ok_pp = true;
+		for(int i = 0; i < 1000; i++){
+			ok_ss &= ss() == reference::starstar128_next(ref);
+			ok_p &= p() == reference::plus128_next(pref);
+			ok_pp &= pp() == reference::plusplus128_next(ppref);
+		}
+		c.expect("reference/xoshiro128ss 1000 values", ok_ss);
+		c.expect("reference/xoshiro128p 1000 values", ok_p);
+		c.expect("reference/xoshiro128pp 1000 values", ok_pp);
+
+		reference::jump128(ref, reference::JUMP128);
+		ss.jump();
+		c.expect_state("reference/xoshiro128 jump", ss, ref);
+		reference::jump128(ref, reference::LONG_JUMP128);
+		ss.long_jump();
+		c.expect_state("reference/xoshiro128 long_jump", ss, ref);
+
+		const uint64_t n = r() % 40;
+		xoshiro128ss a(ref[0], ref[1], ref[2], ref[3]), b(ref[0], ref[1], ref[2], ref[3]);
+		a.jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.jump();
+		c.expect_state("jump-ahead/xoshiro128 jump(n)", a, b.s);
+		a.long_jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.long_jump();
+		c.expect_state("jump-ahead/xoshiro128 long_jump(n)", a, b.s);
+		const uint64_t d = it % 2 ? r() % 2048 : r() % 50000;
+		a.advance(d);
+		for(uint64_t i = 0; i < d; i++)
+			b();
+		c.expect_state("jump-ahead/xoshiro128 advance(n)", a, b.s);
+
+		// top 23 bits plus one half, inside the interval
+		xoshiro128p u(ref[0], ref[1], ref[2], ref[3]), v(ref[0], ref[1], ref[2], ref[3]);
+		bool ok_u = true;
+		for(int i = 0; i < 100; i++){
+			const float x = u.uniform(-2.0f, 6.0f);
+			const uint32_t raw = v();
+			ok_u &= x == -2.0f + 8.0f*(((raw >> 9) + 0.5f) / 8388608.0f) && x > -2.0f && x < 6.0f;
+		}
+		c.expect("uniform/xoshiro128 uniform", ok_u);
+
+		// the iterator hands out the 32-bit words themselves
+		static_assert(std::is_same<engine_iterator<xoshiro128ss>::value_type, uint32_t>::value, "xoshiro128 iterator values");
+		xoshiro128ss w(ss);
+		engine_iterator<xoshiro128ss> pos(ss), begin = pos;
+		bool ok_it = *pos == w();
+		for(int i = 0; i < 10; i++)
+			ok_it &= *++pos == w();
+		for(int i = 0; i < 10; i++)
+			--pos;
+		c.expect("reverse/xoshiro128 iterator", ok_it && pos == begin);
+	}
+	c.expect("uniform/xoshiro128 open ends", xoshiro_detail::unit_float(0) > 0.0f
+			&& xoshiro_detail::unit_float(UINT32_MAX) < 1.0f);
+}
+
+/*
+ * whole states of the large-state engines
+ */
+bool same_state(const xoshiro512ss &a, const xoshiro512ss &b){
+	return !memcmp(a.s, b.s, sizeof(a.s));
+}
+
+bool same_state(const xoroshiro1024ss &a, const xoroshiro1024ss &b){
+	return a.p == b.p && !memcmp(a.s, b.s, sizeof(a.s));
+}
+
+/*
+ * previous(), retreat(n) and engine_iterator for a large-state engine, as
+ * reverse_stepping does for xoshiro256
+ */
+template <class Engine>
+void large_reverse(checker &c, std::mt19937_64 &r, const Engine &start, const std::string &name){
+	std::vector<uint64_t> drawn(1 + r() % 200);
+	Engine a = start;
+	for(uint64_t &x : drawn)
+		x = a();
+	bool same = true;
+	for(size_t i = drawn.size(); i-- > 0 && same; )
+		same = a.previous() == drawn[i];
+	c.expect("reverse/" + name + " previous", same && same_state(a, start));
+
+	// across the short-distance cutoff and well past it
+	const uint64_t d = r() % 2 ? r() % 16384 : r() % 50000;
+	Engine b = start, e = start;
+	b.retreat(d);
+	for(uint64_t i = 0; i < d; i++)
+		e.previous();
+	c.expect("reverse/" + name + " retreat(n)", same_state(b, e), "distance", d);
+	b.advance(d);
+	c.expect("reverse/" + name + " retreat(n)", same_state(b, start), "distance", d);
+	const uint64_t far = r();
+	b.advance(far);
+	b.retreat(far);
+	c.expect("reverse/" + name + " retreat(n)", same_state(b, start), "distance", far);
+
+	Engine f = start;
+	drawn.resize(64);
+	for(uint64_t &x : drawn)
+		x = f();
+	engine_iterator<Engine> pos(start), begin = pos;
+	size_t at = 0;
+	same = *pos == drawn[0];
+	for(int step = 0; step < 200 && same; step++){
+		if(at + 1 < drawn.size() && (at == 0 || r() % 2)){
+			++pos;
+			at++;
+		} else {
+			--pos;
+			at--;
+		}
+		same = *pos == drawn[at];
+	}
+	c.expect("reverse/" + name + " iterator", same, "value", *pos, drawn[at]);
+	while(at--)
+		pos--;
+	c.expect("reverse/" + name + " iterator", pos == begin && !(pos != begin));
+}
+
+/*
+ * xoshiro512 against the reference code, its jump-ahead against walking there,
+ * stepping back, and the Engine templates with it
+ */
+void xoshiro512_family(checker &c, std::mt19937_64 &r, int iterations){
+	for(int it = 0; it < iterations; it++){
+		uint64_t ref[8], pref[8], ppref[8];
+		random_state(r, ref, 8);
+		memcpy(pref, ref, sizeof(ref));
+		memcpy(ppref, ref, sizeof(ref));
+		xoshiro512ss ss(ref);
+		xoshiro512p p(ref);
+		xoshiro512pp pp(ref);
+		if(it % 4 == 0){
+			large_reverse(c, r, ss, "xoshiro512ss");
+			large_reverse(c, r, p, "xoshiro512p");
+			large_reverse(c, r, pp, "xoshiro512pp");
+		}
+		bool ok_ss = true, ok_p = true, ok_pp = true;
+		for(int i = 0; i < 1000; i++){
+			ok_ss &= ss() == reference::starstar512_next(ref);
+			ok_p &= p() == reference::plus512_next(pref);
+			ok_pp &= pp() == reference::plusplus512_next(ppref);
+		}
+		c.expect("reference/xoshiro512ss 1000 values", ok_ss);
+		c.expect("reference/xoshiro512p 1000 values", ok_p);
+		c.expect("reference/xoshiro512pp 1000 values", ok_pp);
+
+		reference::jump512(ref, reference::JUMP512);
+		ss.jump();
+		c.expect_state("reference/xoshiro512 jump", ss, ref);
+		reference::jump512(ref, reference::LONG_JUMP512);
+		ss.long_jump();
+		c.expect_state("reference/xoshiro512 long_jump", ss, ref);
+
+		const uint64_t n = r() % 40;
+		xoshiro512ss a(ref), b(ref);
+		a.jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.jump();
+		c.expect_state("jump-ahead/xoshiro512 jump(n)", a, b.s);
+		a.long_jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.long_jump();
+		c.expect_state("jump-ahead/xoshiro512 long_jump(n)", a, b.s);
+		const uint64_t d = it % 2 ? r() % 8192 : r() % 50000;
+		a.advance(d);
+		for(uint64_t i = 0; i < d; i++)
+			b();
+		c.expect_state("jump-ahead/xoshiro512 advance(n)", a, b.s);
+	}
+
+	// the Engine templates only need the type changed
+	std::vector<uint64_t> got, want;
+	for(int it = 0; it < iterations / 10 + 1; it++){
+		const uint64_t seed = r();
+		const size_t n = r() % 2 ? r() % 5000 : PARALLEL_FILL_BLOCK * 2 + r() % 1000;
+		got.assign(n, 0);
+		want.resize(n);
+		parallel_fill<xoshiro512pp>(got.data(), n, seed, 1 + r() % 4);
+		xoshiro512pp e;
+		seed_engine(e, seed);
+		for(size_t i = 0; i < n; i++)
+			want[i] = e();
+		c.expect_equal("bulk/parallel_fill<xoshiro512pp>", got.data(), want.data(), n);
+
+		uint64_t s[8];
+		random_state(r, s, 8);
+		const xoshiro512ss base(s);
+		per_thread_engines<xoshiro512ss> pte(1 + r() % 6, base);
+		const unsigned i = r() % pte.size();
+		xoshiro512ss ref = base;
+		for(unsigned j = 0; j < i; j++)
+			ref.jump();
+		c.expect_state("bulk/per_thread_engines<xoshiro512>", pte[i], ref.s);
+	}
+}
+
+/*
+ * xoroshiro1024 against the reference code, its jump-ahead against walking
+ * there, stepping back, and the Engine templates with it. the ring start is
+ * compared along with the words.
+ */
+void xoroshiro1024_family(checker &c, std::mt19937_64 &r, int iterations){
+	for(int it = 0; it < iterations; it++){
+		uint64_t ref[16], sref[16];
+		random_state(r, ref, 16);
+		memcpy(sref, ref, sizeof(ref));
+		int p = 0, sp = 0;
+		xoroshiro1024ss ss(ref);
+		xoroshiro1024s s(ref);
+		if(it % 4 == 0){
+			large_reverse(c, r, ss, "xoroshiro1024ss");
+			large_reverse(c, r, s, "xoroshiro1024s");
+		}
+		// a ragged count, so the ring start moves
+		const int m = 1000 + r() % 16;
+		bool ok_ss = true, ok_s = true;
+		for(int i = 0; i < m; i++){
+			ok_ss &= ss() == reference::starstar1024_next(ref, p);
+			ok_s &= s() == reference::star1024_next(sref, sp);
+		}
+		c.expect("reference/xoroshiro1024ss 1000 values", ok_ss);
+		c.expect("reference/xoroshiro1024s 1000 values", ok_s);
+
+		reference::jump1024(ref, p, reference::JUMP1024);
+		ss.jump();
+		c.expect_state("reference/xoroshiro1024 jump", ss, ref, p);
+		reference::jump1024(ref, p, reference::LONG_JUMP1024);
+		ss.long_jump();
+		c.expect_state("reference/xoroshiro1024 long_jump", ss, ref, p);
+
+		const uint64_t n = r() % 20;
+		xoroshiro1024ss a = ss, b = ss;
+		a.jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.jump();
+		c.expect_state("jump-ahead/xoroshiro1024 jump(n)", a, b.s, b.p);
+		a.long_jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.long_jump();
+		c.expect_state("jump-ahead/xoroshiro1024 long_jump(n)", a, b.s, b.p);
+		const uint64_t d = it % 2 ? r() % 16384 : r() % 50000;
+		a.advance(d);
+		for(uint64_t i = 0; i < d; i++)
+			b();
+		c.expect_state("jump-ahead/xoroshiro1024 advance(n)", a, b.s, b.p);
+	}
+
+	std::vector<uint64_t> got, want;
+	for(int it = 0; it < iterations / 10 + 1; it++){
+		const uint64_t seed = r();
+		const size_t n = r() % 2 ? r() % 5000 : PARALLEL_FILL_BLOCK * 2 + r() % 1000;
+		got.assign(n, 0);
+		want.resize(n);
+		parallel_fill<xoroshiro1024ss>(got.data(), n, seed, 1 + r() % 4);
+		xoroshiro1024ss e;
+		seed_engine(e, seed);
+		for(size_t i = 0; i < n; i++)
+			want[i] = e();
+		c.expect_equal("bulk/parallel_fill<xoroshiro1024>", got.data(), want.data(), n);
+
+		uint64_t s[16];
+		random_state(r, s, 16);
+		const xoroshiro1024ss base(s);
+		engine_pool<xoroshiro1024ss> pool(4, base);
+		const uint64_t task = r() % 100000;
+		auto lease = pool.checkout(task);
+		xoroshiro1024ss t = base;
+		t.long_jump();
+		t.jump(task);
+		c.expect_state("bulk/engine_pool<xoroshiro1024>", *lease, t.s, t.p);
+	}
+}
+
+/*
+ * the constant-time jump-ahead functions against walking there
+ */
+void jump_ahead(checker &c, std::mt19937_64 &r, int iterations){
+	for(int it = 0; it < iterations; it++){
+		uint64_t s[4];
+		random_state(r, s);
+		const uint64_t n = r() % 40;
+		xoshiro256ss a(s[0], s[1], s[2], s[3]), b(s[0], s[1], s[2], s[3]);
+		a.jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.jump();
+		c.expect_state("jump-ahead/jump(n)", a, b.s);
+		a.long_jump(n);
+		for(uint64_t i = 0; i < n; i++)
+			b.long_jump();
+		c.expect_state("jump-ahead/long_jump(n)", a, b.s);
+
+		// across the short-distance cutoff and well past it
+		const uint64_t d = it % 2 ? r() % 2048 : r() % 50000;
+		a.advance(d);
+		for(uint64_t i = 0; i < d; i++)
+			b();
+		c.expect_state("jump-ahead/advance(n)", a, b.s);
+
+		// the same distance split two ways
+		uint64_t big[4];
+		for(int w = 0; w < 4; w++)
+			big[w] = b.s[w];
+		xoshiro256ss e(big[0], big[1], big[2], big[3]);
+		e.advance(UINT64_C(1) << 63);
+		e.advance(UINT64_C(1) << 63);
+		xoshiro256ss f(big[0], big[1], big[2], big[3]);
+		for(int i = 0; i < 4; i++)
+			f.advance(UINT64_C(1) << 62);
+		c.expect_state("jump-ahead/advance 2^64", e, f.s);
+
+		// split() is four draws through mix()
+		xoshiro256ss parent(s[0], s[1], s[2], s[3]), copy(s[0], s[1], s[2], s[3]);
+		xoshiro256ss child = parent.split();
+		uint64_t want[4];
+		for(int i = 0; i < 4; i++)
+			want[i] = splitmix64::mix(copy() + 0x9e3779b97f4a7c15);
+		c.expect_state("jump-ahead/split", child, want);
+		c.expect_state("jump-ahead/split parent", parent, copy.s);
+	}
+}
+
+/*
+ * stepping backwards against what was drawn going forwards
+ */
+template <class Engine>
+void reverse_stepping(checker &c, std::mt19937_64 &r, int iterations, const std::string &name){
+	std::vector<uint64_t> drawn;
+	for(int it = 0; it < iterations; it++){
+		uint64_t s[4];
+		random_state(r, s);
+		Engine a(s[0], s[1], s[2], s[3]);
+		drawn.resize(1 + r() % 200);
+		for(uint64_t &x : drawn)
+			x = a();
+		bool same = true;
+		for(size_t i = drawn.size(); i-- > 0 && same; )
+			same = a.previous() == drawn[i];
+		c.expect("reverse/" + name + " previous", same, "values from", s[0]);
+		c.expect_state("reverse/" + name + " previous", a, s);
+
+		// across the short-distance cutoff and well past it
+		const uint64_t d = it % 2 ? r() % 8192 : r() % 50000;
+		Engine b(s[0], s[1], s[2], s[3]), e(s[0], s[1], s[2], s[3]);
+		b.retreat(d);
+		for(uint64_t i = 0; i < d; i++)
+			e.previous();
+		c.expect_state("reverse/" + name + " retreat(n)", b, e.s);
+		b.advance(d);
+		c.expect_state("reverse/" + name + " retreat(n)", b, s);
+		const uint64_t far = r();
+		b.advance(far);
+		b.retreat(far);
+		c.expect_state("reverse/" + name + " retreat(n)", b, s);
+
+		// a random walk of the iterator against the values drawn forwards
+		Engine f(s[0], s[1], s[2], s[3]);
+		drawn.resize(64);
+		for(uint64_t &x : drawn)
+			x = f();
+		engine_iterator<Engine> pos(Engine(s[0], s[1], s[2], s[3])), start = pos;
+		size_t at = 0;
+		same = *pos == drawn[0];
+		for(int step = 0; step < 200 && same; step++){
+			if(at + 1 < drawn.size() && (at == 0 || r() % 2)){
+				++pos;
+				at++;
+			} else {
+				--pos;
+				at--;
+			}
+			same = *pos == drawn[at];
+		}
+		c.expect("reverse/" + name + " iterator", same, "value", *pos, drawn[at]);
+		while(at--)
+			pos--;
+		c.expect("reverse/" + name + " iterator", pos == start && !(pos != start));
+	}
+}
+
+/*
+ * replayed states against the states met while drawing. without XOSHIRO_REPLAY
+ * the checkpoints are taken by hand every 2^k draws, as the engine would.
+ */
+template <class Engine>
+void replay(checker &c, std::mt19937_64 &r, int iterations, const std::string &engine){
+	const unsigned W = Engine::family::words;
+	for(int it = 0; it < iterations; it++){
+		const unsigned k = r() % 12;
+		replay_log log(k);
+		Engine e = random_engine<Engine>(r);
+		std::vector<uint64_t> states;
+		const size_t n = 1 + r() % 5000;
+#ifdef XOSHIRO_REPLAY
+		e.record(&log);
+#endif
+		for(size_t i = 0; i <= n; i++){
+			const std::vector<uint64_t> s = state_of(e);
+			states.insert(states.end(), s.begin(), s.end());
+#ifndef XOSHIRO_REPLAY
+			if(i % (UINT64_C(1) << k) == 0)
+				log.checkpoint(i, e);
+#endif
+			e();
+		}
+#ifdef XOSHIRO_REPLAY
+		const size_t checkpoints = ((n + 1) >> k) + 1; // the engine stops at position n + 1
+#else
+		const size_t checkpoints = (n >> k) + 1;
+#endif
+		c.expect("replay/checkpoints " + engine, log.size() == checkpoints, "count", log.size(), checkpoints);
+
+		std::vector<char> text(log.dump_size());
+		replay_log copy;
+		c.expect("replay/dump and parse " + engine, log.dump(text.data(), text.size()) == text.size()
+				&& copy.parse(text.data(), text.size()) && copy.size() == log.size() && copy.interval_bits() == k);
+		text.back() = 'x';
+		c.expect("replay/dump and parse " + engine, !copy.parse(text.data(), text.size()) && copy.size() == log.size());
+
+		typename Engine::word got[Engine::family::words];
+		for(int q = 0; q < 20; q++){
+			const size_t i = r() % (n + 1);
+			copy.state_at<Engine>(i, got);
+			c.expect_equal("replay/state_at " + engine, state_of(Engine(got)).data(), &states[W*i], W, "s");
+		}
+
+#ifdef XOSHIRO_REPLAY
+		// the engine keeps its own checkpoints across moves in both directions
+		const uint64_t back = r() % n, ahead = r() % 100000;
+		e.retreat(back);
+		e.advance(ahead);
+		c.expect("replay/position " + engine, e.position() == n + 1 - back + ahead, "position", e.position(), n + 1 - back + ahead);
+		Engine at = log.engine_at<Engine>(e.position());
+		c.expect_equal("replay/after advance " + engine, state_of(at).data(), state_of(e).data(), W, "s");
+		c.expect("replay/position " + engine, at.position() == e.position(), "position", at.position(), e.position());
+		e.jump();
+		const std::vector<uint64_t> jumped = state_of(e);
+		const uint64_t p = e.position();
+		for(int i = 0; i < 3; i++)
+			e();
+		log.state_at<Engine>(p + 3, got);
+		c.expect_equal("replay/after jump " + engine, state_of(Engine(got)).data(), state_of(e).data(), W, "s");
+		log.state_at<Engine>(p, got);
+		c.expect_equal("replay/after jump " + engine, state_of(Engine(got)).data(), jumped.data(), W, "s");
+		const size_t i = r() % (n + 1 - back);
+		log.state_at<Engine>(i, got);
+		c.expect_equal("replay/before jump " + engine, state_of(Engine(got)).data(), &states[W*i], W, "s");
+#endif
+	}
+}
+
+/*
+ * splitmix64's counter-based functions against operator()
+ */
+void splitmix_bulk(checker &c, std::mt19937_64 &r, int iterations){
+	std::vector<uint64_t> got, want;
+	for(int it = 0; it < iterations; it++){
+		const uint64_t seed = r();
+		const size_t n = r() % 3000;
+		splitmix64 a(seed), b(seed);
+		got.resize(n);
+		want.resize(n);
+		a.fill(got.data(), n);
+		for(size_t i = 0; i < n; i++)
+			want[i] = b();
+		c.expect_equal("bulk/splitmix64 fill", got.data(), want.data(), n);
+		c.expect("bulk/splitmix64 fill position", a() == b());
+
+		const uint64_t k = r() % 5000;
+		splitmix64 d(seed), e(seed);
+		const uint64_t at = d.at(k);
+		d.discard(k);
+		for(uint64_t i = 0; i < k; i++)
+			e();
+		const uint64_t next = e();
+		c.expect("bulk/splitmix64 at", at == next, "at(k)", at, next);
+		c.expect("bulk/splitmix64 discard", d() == next);
+	}
+}
+
+/*
+ * basic_engine_array against one scalar engine per lane
+ */
+template <class Engine>
+void engine_array_bulk(checker &c, std::mt19937_64 &r, int iterations, const std::string &engine){
+	typedef basic_engine_array<Engine> array;
+	typedef typename Engine::word word;
+	const std::string name = "bulk/engine_array " + engine;
+	// enough engines for the tabulated bulk jumps, see basic_engine_array
+	const size_t many = 4 * 64 * xoshiro_detail::field_words<typename Engine::family>();
+	for(int it = 0; it < iterations; it++){
+		// now and then enough engines for the tabulated bulk jumps
+		const size_t n = it % 10 == 9 ? many + r() % 100 : 1 + r() % 70;
+		const Engine base = random_engine<Engine>(r);
+		array arr = it % 2 ? array(n, base) : array(n, r());
+		std::vector<Engine> lanes;
+		for(size_t i = 0; i < n; i++)
+			lanes.push_back(arr.get(i));
+		if(it % 2){
+			Engine e = base;
+			bool ok = true;
+			for(size_t i = 0; i < n; i++, e.jump())
+				ok &= state_of(lanes[i]) == state_of(e);
+			c.expect(name + " seed_jumped", ok);
+		}
+
+		std::vector<word> got(n);
+		std::vector<uint64_t> g(n), want(n);
+		std::vector<uint32_t> idx;
+		for(int round = 0; round < 40; round++){
+			switch(r() % 5){
+			case 0: // all lanes
+				arr.next(got.data());
+				for(size_t i = 0; i < n; i++){
+					g[i] = got[i];
+					want[i] = lanes[i]();
+				}
+				c.expect_equal(name + " next", g.data(), want.data(), n);
+				break;
+			case 1: { // a random subset of lanes
+				idx.clear();
+				for(uint32_t i = 0; i < n; i++)
+					if(r() % 2)
+						idx.push_back(i);
+				arr.next(idx.data(), idx.size(), got.data());
+				for(size_t k = 0; k < idx.size(); k++){
+					g[k] = got[k];
+					want[k] = lanes[idx[k]]();
+				}
+				c.expect_equal(name + " next(idx)", g.data(), want.data(), idx.size());
+				break;
+			}
+			case 2: { // one lane
+				const size_t i = r() % n;
+				const uint64_t v = arr(i), w = lanes[i]();
+				c.expect(name + " operator()(i)", v == w, "value", v, w);
+				break;
+			}
+			case 3:
+				if(r() % 2){
+					arr.jump();
+					for(auto &e : lanes)
+						e.jump();
+				} else {
+					arr.long_jump();
+					for(auto &e : lanes)
+						e.long_jump();
+				}
+				break;
+			case 4: { // set and get round trip
+				const size_t i = r() % n;
+				lanes[i] = random_engine<Engine>(r);
+				arr.set(i, lanes[i]);
+				break;
+			}
+			}
+		}
+		bool ok = true;
+		for(size_t i = 0; i < n; i++)
+			ok &= state_of(arr.get(i)) == state_of(lanes[i]);
+		c.expect(name + " final state", ok);
+	}
+}
+
+/*
+ * interleaved<N> against N jumped engines read in turn, mixing single values
+ * and fills of random length
+ */
+template <unsigned N, class Engine>
+void interleaved_bulk(checker &c, std::mt19937_64 &r, int iterations, const std::string &engine){
+	const std::string name = "bulk/interleaved<" + std::to_string(N) + "> " + engine;
+	std::vector<typename Engine::word> got;
+	std::vector<uint64_t> g, want;
+	for(int it = 0; it < iterations; it++){
+		Engine base = random_engine<Engine>(r);
+		interleaved<N, Engine> il(base);
+		std::vector<Engine> streams;
+		for(unsigned j = 0; j < N; j++, base.jump())
+			streams.push_back(base);
+		uint64_t k = 0; // values drawn so far
+		for(int round = 0; round < 20; round++){
+			const size_t n = r() % 3 ? r() % 50 : 1;
+			got.resize(n);
+			g.resize(n);
+			want.resize(n);
+			if(n == 1)
+				got[0] = il();
+			else
+				il.fill(got.data(), n);
+			for(size_t i = 0; i < n; i++, k++){
+				g[i] = got[i];
+				want[i] = streams[k % N]();
+			}
+			c.expect_equal(name + " fill/()", g.data(), want.data(), n);
+		}
+		// jump drops the buffered values, whose streams have already stepped past them
+		for(; k % N; k++)
+			streams[k % N]();
+		il.jump();
+		for(auto &e : streams)
+			e.jump();
+		bool ok = true;
+		for(unsigned j = 0; j < N; j++)
+			ok &= state_of(il.stream(j)) == state_of(streams[j]);
+		c.expect(name + " jump", ok);
+	}
+}
+
+/*
+ * xoshiro128_lanes<L> against L jumped engines read in turn, through (), fill,
+ * uniform and fill_uniform of random lengths
+ */
+template <unsigned L, class Engine>
+void lanes_bulk(checker &c, std::mt19937_64 &r, int iterations, const std::string &engine){
+	const std::string name = "bulk/lanes<" + std::to_string(L) + "> " + engine;
+	std::vector<uint32_t> got;
+	std::vector<float> gotf;
+	std::vector<uint64_t> g, want;
+	for(int it = 0; it < iterations; it++){
+		uint32_t s[4];
+		random_state(r, s);
+		Engine base(s[0], s[1], s[2], s[3]);
+		xoshiro128_lanes<L, Engine> lanes(base);
+		std::vector<Engine> streams;
+		for(unsigned j = 0; j < L; j++, base.jump())
+			streams.push_back(Engine(base.s[0], base.s[1], base.s[2], base.s[3]));
+		uint64_t k = 0; // values drawn so far
+		for(int round = 0; round < 20; round++){
+			const size_t n = r() % 3 ? r() % 100 : 1;
+			const bool floats = r() % 2;
+			got.resize(n);
+			gotf.resize(n);
+			g.resize(n);
+			want.resize(n);
+			if(floats){
+				if(n == 1)
+					gotf[0] = lanes.uniform(-1.0f, 1.0f);
+				else
+					lanes.fill_uniform(gotf.data(), n, -1.0f, 1.0f);
+				// compared bit for bit, as integers
+				for(size_t i = 0; i < n; i++, k++){
+					const float x = streams[k % L].uniform(-1.0f, 1.0f);
+					uint32_t a, b;
+					memcpy(&a, &gotf[i], sizeof(a));
+					memcpy(&b, &x, sizeof(b));
+					g[i] = a;
+					want[i] = b;
+				}
+				c.expect_equal(name + " uniform", g.data(), want.data(), n);
+			} else {
+				if(n == 1)
+					got[0] = lanes();
+				else
+					lanes.fill(got.data(), n);
+				for(size_t i = 0; i < n; i++, k++){
+					g[i] = got[i];
+					want[i] = streams[k % L]();
+				}
+				c.expect_equal(name + " fill", g.data(), want.data(), n);
+			}
+		}
+		for(; k % L; k++)
+			streams[k % L]();
+		lanes.jump();
+		for(auto &e : streams)
+			e.jump();
+		bool ok = true;
+		for(unsigned j = 0; j < L; j++)
+			ok &= !memcmp(lanes.stream(j).s, streams[j].s, sizeof(streams[j].s));
+		c.expect(name + " jump", ok);
+	}
+}
+
+/*
+ * moves the calling thread to the k-th cpu it may run on, counting round, so
+ * two threads with different k sit on different cores where there are two
+ */
+void pin_thread(unsigned k){
+#ifdef __linux__
+	cpu_set_t allowed, one;
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+		return;
+	k %= CPU_COUNT(&allowed);
+	for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		if(CPU_ISSET(cpu, &allowed) && k-- == 0){
+			CPU_ZERO(&one);
+			CPU_SET(cpu, &one);
+			sched_setaffinity(0, sizeof(one), &one);
+			return;
+		}
+#else
+	(void)k;
+#endif
+}
+
+/*
+ * the threaded bulk paths. they are slower, so they get fewer cases.
+ */
+void threaded_bulk(checker &c, std::mt19937_64 &r, int iterations){
+	std::vector<uint64_t> got, want;
+	for(int it = 0; it < iterations; it++){
+		const uint64_t seed = r();
+		const size_t n = r() % 3 ? r() % 5000 : PARALLEL_FILL_BLOCK * 2 + r() % 1000;
+		const unsigned threads = 1 + r() % 4;
+		got.assign(n, 0);
+		want.resize(n);
+		parallel_fill(got.data(), n, seed, threads);
+		xoshiro256ss e(0, 0, 0, 0);
+		seed_engine(e, seed);
+		for(size_t i = 0; i < n; i++)
+			want[i] = e();
+		c.expect_equal("bulk/parallel_fill", got.data(), want.data(), n);
+
+		// seeding starts a ring over, so a used engine reseeded is a fresh one
+		xoroshiro1024s used = random_engine<xoroshiro1024s>(r);
+		for(int k = r() % 40; k > 0; k--)
+			used();
+		seed_engine(used, seed);
+		parallel_fill<xoroshiro1024s>(got.data(), n, seed, threads);
+		for(size_t i = 0; i < n; i++)
+			want[i] = used();
+		c.expect_equal("bulk/parallel_fill reseeded ring", got.data(), want.data(), n);
+
+		uint64_t s[4];
+		random_state(r, s);
+		const xoshiro256ss base(s[0], s[1], s[2], s[3]);
+		per_thread_engines<> pte(1 + r() % 6, base, r() % 2);
+		const unsigned i = r() % pte.size();
+		xoshiro256ss ref = base;
+		for(unsigned j = 0; j < i; j++)
+			ref.jump();
+		c.expect_state("bulk/per_thread_engines", pte[i], ref.s);
+
+		engine_pool<> pool(4, base);
+		const uint64_t task = r() % 100000;
+		auto lease = pool.checkout(task);
+		xoshiro256ss t = base;
+		t.long_jump();
+		t.jump(task);
+		c.expect_state("bulk/engine_pool checkout(task)", *lease, t.s);
+	}
+
+	// engines given back on one thread can all be checked out on another
+	for(int it = 0; it < iterations / 4 + 1; it++){
+		const uint32_t n = 1 + r() % 200;
+		engine_pool<> pool(n, xoshiro256ss(), 2 + r() % 6);
+		std::vector<engine_pool<>::lease> out;
+		std::set<const xoshiro256ss*> seen;
+		// the second thread starts while the first is alive, so it has another id
+		std::thread([&]{
+			pin_thread(0);
+			for(uint32_t k = 0; k < n; k++)
+				out.push_back(pool.checkout());
+			out.clear();
+			std::thread([&]{
+				pin_thread(1);
+				for(uint32_t k = 0; k < n; k++){
+					auto l = pool.checkout();
+					if(l)
+						seen.insert(&*l);
+					out.push_back(std::move(l));
+				}
+			}).join();
+		}).join();
+		c.expect("bulk/engine_pool across threads", seen.size() == n && !pool.checkout(), "engines", seen.size(), n);
+	}
+
+	// one consumer sees the producer's order: engine_array(LANES, seed) stepped in turn
+	for(int it = 0; it < iterations / 4 + 1; it++){
+		const uint64_t seed = r();
+		const size_t n = 1000 + r() % 20000;
+		random_feeder feeder(1024, seed);
+		got.resize(n);
+		// the producer publishes LANES values at a time, and a stall ends with a claim
+		// of all that is in, so one read of m values stalls at most m / LANES + 1 times
+		uint64_t most_stalls = 0;
+		for(size_t k = 0; k < n; ){
+			const size_t m = std::min<size_t>(n - k, 1 + r() % 300);
+			feeder.read(got.data() + k, m);
+			most_stalls += m / random_feeder::LANES + 1;
+			k += m;
+		}
+		const random_feeder::stats st = feeder.statistics();
+		c.expect("bulk/random_feeder stalls", st.stalls <= most_stalls && st.produced >= n, "stalls", st.stalls, most_stalls);
+		engine_array lanes(random_feeder::LANES, seed);
+		want.resize(n + random_feeder::LANES);
+		for(size_t k = 0; k < n; k += random_feeder::LANES)
+			lanes.next(want.data() + k);
+		c.expect_equal("bulk/random_feeder", got.data(), want.data(), n);
+	}
+}
+
+#if defined(__cpp_lib_ranges)
+/*
+ * the views against the member functions on a copy of the engine, in the
+ * engine's own word and real types
+ */
+template <class Engine>
+void ranges_bulk(checker &c, std::mt19937_64 &r, int iterations, const std::string &name){
+	typedef typename Engine::word word;
+	typedef typename Engine::real real;
+	for(int it = 0; it < iterations; it++){
+		const Engine e = random_engine<Engine>(r);
+		const size_t n = r() % 500;
+		Engine a(e), b(e);
+		bool ok_raw = true, ok_uni = true, ok_exp = true, ok_geo = true;
+		size_t k = 0;
+		for(word v : xoshiro::views::random(a) | std::views::take(n)){
+			ok_raw &= v == b();
+			k++;
+		}
+		// a view reads ahead by whole blocks, so every view gets fresh engines
+		Engine ua(e), ub(e);
+		for(real v : xoshiro::views::uniform(ua, -1, 3) | std::views::take(n))
+			ok_uni &= v == ub.uniform(-1, 3);
+		Engine ea(e), eb(e);
+		for(real v : xoshiro::views::exponential(ea, 2.5) | std::views::take(n))
+			ok_exp &= v == eb.exponential(2.5);
+		Engine ga(e), gb(e);
+		for(int v : xoshiro::views::geometric(ga, 0.3) | std::views::take(n))
+			ok_geo &= v == gb.geometric(0.3);
+		c.expect("bulk/views::random " + name, ok_raw && k == n);
+		c.expect("bulk/views::uniform " + name, ok_uni);
+		c.expect("bulk/views::exponential " + name, ok_exp);
+		c.expect("bulk/views::geometric " + name, ok_geo);
+	}
+}
+
+/*
+ * an xoshiro256p behind a base class reference draws its own values
+ */
+void ranges_virtual(checker &c, std::mt19937_64 &r, int iterations){
+	for(int it = 0; it < iterations; it++){
+		uint64_t s[4];
+		random_state(r, s);
+		const size_t n = r() % 500;
+		xoshiro256p pa(s[0], s[1], s[2], s[3]), pb(s[0], s[1], s[2], s[3]);
+		xoshiro256ss &pref = pa;
+		bool ok_p = true;
+		for(uint64_t v : xoshiro::views::random(pref) | std::views::take(n))
+			ok_p &= v == pb();
+		c.expect("bulk/views::random on xoshiro256p", ok_p);
+	}
+}
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+/*
+ * two registries on one file stand in for two processes. slot k is the seeded
+ * engine after k long jumps whichever registry claims it.
+ */
+template <class Engine>
+void shared_streams(checker &c, std::mt19937_64 &r, int iterations, const std::string &name){
+	char path[] = "/tmp/xoshiro_selfcheck_XXXXXX";
+	const int fd = mkstemp(path);
+	c.expect("shm/" + name + " file", fd >= 0);
+	if(fd < 0)
+		return;
+	close(fd);
+	const uint64_t seed = r();
+	Engine base;
+	seed_engine(base, seed);
+	{
+		basic_stream_registry<Engine> a(path, seed), b(path, seed);
+		for(int k = 0; k < iterations; k++){
+			Engine e = (r() % 2 ? a : b).engine();
+			Engine want = base;
+			want.long_jump(k);
+			c.expect("shm/" + name + " slots", state_of(e) == state_of(want), "slot", k);
+		}
+
+		// the child's copy of an attached engine moves to the next slot, the parent's stays
+		Engine e = a.engine();
+		const std::vector<uint64_t> before = state_of(e);
+		a.attach(e);
+		int pipefd[2];
+		c.expect("shm/" + name + " fork", pipe(pipefd) == 0);
+		const pid_t pid = fork();
+		if(pid == 0){
+			const std::vector<uint64_t> s = state_of(e);
+			const ssize_t wrote = write(pipefd[1], s.data(), s.size() * sizeof(uint64_t));
+			_exit(wrote == (ssize_t)(s.size() * sizeof(uint64_t)) ? 0 : 1);
+		}
+		close(pipefd[1]);
+		std::vector<uint64_t> child(before.size());
+		size_t got = 0;
+		for(ssize_t k; got < child.size() * sizeof(uint64_t) && (k = read(pipefd[0], (char*)child.data() + got, child.size() * sizeof(uint64_t) - got)) > 0;)
+			got += k;
+		close(pipefd[0]);
+		int status = 0;
+		waitpid(pid, &status, 0);
+		Engine want = base;
+		want.long_jump(iterations + 1);
+		c.expect("shm/" + name + " fork", pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0
+				&& child == state_of(want) && state_of(e) == before);
+		a.detach(e);
+	}
+	unlink(path);
+}
+#endif
+
+#ifdef XOSHIRO_INSTRUMENT
+/*
+ * a label's totals in a snapshot, zeros if it isn't there
+ */
+xoshiro_instrument::totals totals_of(const char *label){
+	for(const xoshiro_instrument::totals &t : xoshiro_instrument::snapshot())
+		if(t.label == label)
+			return t;
+	return xoshiro_instrument::totals();
+}
+
+/*
+ * labeled engines are counted while they live, unlabeled ones once destroyed
+ */
+void instrument_counts(checker &c, std::mt19937_64 &r){
+	const uint64_t n = 1 + r() % 1000, m = 1 + r() % 1000;
+	const xoshiro_instrument::totals before = totals_of("(unlabeled)");
+	{
+		xoshiro256ss a, b;
+		xoshiro_instrument::label(a, "selfcheck");
+		for(uint64_t i = 0; i < n; i++)
+			a();
+		for(uint64_t i = 0; i < m; i++)
+			b();
+		xoshiro256ss copy(a);
+		copy();
+		const xoshiro_instrument::totals live = totals_of("selfcheck");
+		c.expect("instrument/labeled", live.draws == n + 1 && live.engines == 2, "draws", live.draws, n + 1);
+		c.expect("instrument/unlabeled", totals_of("(unlabeled)").draws == before.draws, "draws while alive", totals_of("(unlabeled)").draws, before.draws);
+	}
+	const xoshiro_instrument::totals gone = totals_of("selfcheck"), after = totals_of("(unlabeled)");
+	c.expect("instrument/labeled", gone.draws == n + 1 && gone.engines == 2, "draws", gone.draws, n + 1);
+	c.expect("instrument/unlabeled", after.draws - before.draws == m && after.engines - before.engines == 1, "draws", after.draws - before.draws, m);
+}
+#endif
+
+/*
+ * the formatters against slow but obvious versions, and back through the
+ * parsers
+ */
+void formatting(checker &c, std::mt19937_64 &r, int iterations){
+	char buf[80], want[80];
+	uint64_t v, got;
+	const char *b64 = xoshiro_io::to_base64(buf, buf + sizeof(buf), 0x0123456789abcdef) ? buf : "";
+	c.expect("format/base64 known answer", !memcmp(b64, "ASNFZ4mrze8", 11), "0x0123456789abcdef");
+	c.expect("format/short buffer", !xoshiro_io::to_hex(buf, buf + 15, 0) && !xoshiro_io::to_binary(buf, buf + 63, 0)
+			&& !xoshiro_io::to_base64(buf, buf + 10, 0));
+	const char bad_hex[] = "0123456789abcdeg";
+	const char bad_base64[] = "ASNFZ4mrze9"; // the last character sets bits past the value
+	const std::string bad_binary = std::string(63, '0') + "2";
+	c.expect("format/bad digits", !xoshiro_io::from_hex(bad_hex, bad_hex + 16, got)
+			&& !xoshiro_io::from_binary(bad_binary.data(), bad_binary.data() + 64, got)
+			&& !xoshiro_io::from_base64(bad_base64, bad_base64 + 11, got));
+	for(int it = 0; it < iterations * 10; it++){
+		// values with long runs of zeros and ones as well as random ones
+		v = r();
+		if(it % 3 == 1)
+			v >>= r() % 64;
+		else if(it % 3 == 2)
+			v |= ~UINT64_C(0) << (r() % 64);
+
+		snprintf(want, sizeof(want), "%016llx", (unsigned long long)v);
+		char *end = xoshiro_io::to_hex(buf, buf + sizeof(buf), v);
+		c.expect("format/hex", end == buf + 16 && !memcmp(buf, want, 16), "value", v);
+		c.expect("format/hex parse", xoshiro_io::from_hex(buf, end, got) == end && got == v, "parsed", got, v);
+		for(int i = 0; i < 16; i++)
+			want[i] = toupper((unsigned char)want[i]);
+		c.expect("format/hex parse", xoshiro_io::from_hex(want, want + 16, got) && got == v, "parsed upper case", got, v);
+
+		for(int i = 0; i < 64; i++)
+			want[i] = '0' + (v >> (63 - i) & 1);
+		end = xoshiro_io::to_binary(buf, buf + sizeof(buf), v);
+		c.expect("format/binary", end == buf + 64 && !memcmp(buf, want, 64), "value", v);
+		c.expect("format/binary parse", xoshiro_io::from_binary(buf, end, got) == end && got == v, "parsed", got, v);
+		c.expect("format/UI64T2String", UI64T2String(v) == std::string(want, 64), "value", v);
+
+		// the 8 big-endian bytes, 6 bits at a time
+		static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		unsigned acc = 0, bits = 0, n = 0;
+		for(int i = 7; i >= 0; i--){
+			acc = acc << 8 | (unsigned)(v >> 8*i & 0xff);
+			for(bits += 8; bits >= 6; bits -= 6)
+				want[n++] = alphabet[acc >> (bits - 6) & 0x3f];
+		}
+		want[n++] = alphabet[acc << (6 - bits) & 0x3f];
+		end = xoshiro_io::to_base64(buf, buf + sizeof(buf), v);
+		c.expect("format/base64", end == buf + 11 && n == 11 && !memcmp(buf, want, 11), "value", v);
+		c.expect("format/base64 parse", xoshiro_io::from_base64(buf, end, got) == end && got == v, "parsed", got, v);
+	}
+
+	for(int it = 0; it < iterations; it++){
+		const size_t n = 1 + r() % 100;
+		engine_array a(n, r()), b(n, r());
+		std::vector<char> text(a.dump_size());
+		c.expect("format/array dump", a.dump_states(text.data(), text.size()) == text.size()
+				&& a.dump_states(text.data(), text.size() - 1) == 0, "engines", n);
+		for(size_t i = 0; i < n; i++){
+			xoshiro256ss e(1, 1, 1, 1);
+			const char *line = text.data() + i * (xoshiro_io::STATE_CHARS + 1);
+			xoshiro_io::from_hex(line, line + xoshiro_io::STATE_CHARS, e);
+			c.expect_state("format/array dump", e, a.get(i).s);
+		}
+		// a truncated dump sets only the complete lines
+		const size_t cut = r() % (text.size() + 1);
+		const size_t whole = cut < xoshiro_io::STATE_CHARS ? 0 : (cut - xoshiro_io::STATE_CHARS) / (xoshiro_io::STATE_CHARS + 1) + 1;
+		c.expect("format/array parse", b.parse_states(text.data(), cut) == whole, "engines", b.parse_states(text.data(), cut), whole);
+		c.expect("format/array parse", b.parse_states(text.data(), text.size()) == n, "engines", n);
+		for(size_t i = 0; i < n; i++)
+			c.expect_state("format/array parse", b.get(i), a.get(i).s);
+	}
+
+	// fewer engines than a state has words, and none at all
+	for(int it = 0; it < iterations; it++){
+		const size_t n = r() % 4;
+		basic_engine_array<xoroshiro1024ss> a(n, r()), b(n, r());
+		std::vector<char> text(a.dump_size() + 1);
+		const size_t size = a.dump_states(text.data(), text.size());
+		c.expect("format/array parse<xoroshiro1024>", b.parse_states(text.data(), size) == n, "engines", n);
+		for(size_t i = 0; i < n; i++)
+			c.expect("format/array parse<xoroshiro1024>", state_of(b.get(i)) == state_of(a.get(i)), "engine", i);
+	}
+}
+
+namespace ct = xoshiro::ct;
+
+/*
+ * value n of an engine, in a constant expression
+ */
+template <class Engine>
+constexpr ct::result_t<Engine> nth(Engine e, int n){
+	for(int i = 0; i < n; i++)
+		e();
+	return e();
+}
+
+template <class Engine>
+constexpr Engine jumped(Engine e, bool long_jump){
+	if(long_jump)
+		e.long_jump();
+	else
+		e.jump();
+	return e;
+}
+
+template <class T, size_t N>
+constexpr bool is_permutation(const ct::table<T, N> &t){
+	bool seen[N] = {};
+	for(size_t i = 0; i < N; i++){
+		if(t[i] >= N || seen[t[i]])
+			return false;
+		seen[t[i]] = true;
+	}
+	return true;
+}
+
+// the known answers again, this time evaluated by the compiler
+static_assert(ct::splitmix64(0)() == 0xe220a8397b1dcdaf, "constexpr splitmix64");
+static_assert(nth(ct::xoshiro256ss(1, 2, 3, 4), 5) == 0x0870021ce143ad00, "constexpr xoshiro256ss");
+static_assert(nth(ct::xoshiro256p(1, 2, 3, 4), 5) == 0xc0617014120f0583, "constexpr xoshiro256p");
+static_assert(nth(ct::xoshiro128ss(1, 2, 3, 4), 5) == 0x61963b24, "constexpr xoshiro128ss");
+static_assert(nth(ct::xoshiro128p(1, 2, 3, 4), 5) == 0x43f87e19, "constexpr xoshiro128p");
+static_assert(nth(ct::xoshiro128pp(1, 2, 3, 4), 5) == 0xfd275ab0, "constexpr xoshiro128pp");
+static_assert(jumped(ct::xoshiro256ss(1, 2, 3, 4), false).s[0] == 0x8c7a153956b5f3d1
+		&& jumped(ct::xoshiro256ss(1, 2, 3, 4), false).s[3] == 0x8386b786c4408050, "constexpr jump");
+static_assert(jumped(ct::xoshiro256ss(1, 2, 3, 4), true).s[0] == 0x096a8eb71295a400
+		&& jumped(ct::xoshiro256ss(1, 2, 3, 4), true).s[3] == 0x31655ca1a2215bf1, "constexpr long_jump");
+static_assert(jumped(ct::xoshiro128ss(1, 2, 3, 4), false).s[0] == 0xa9765206
+		&& jumped(ct::xoshiro128ss(1, 2, 3, 4), true).s[0] == 0x6014af26, "constexpr xoshiro128 jumps");
+static_assert(is_permutation(ct::shuffled<100, uint16_t>(ct::xoshiro256ss(7))), "constexpr shuffled");
+static_assert(is_permutation(ct::shuffled<100, uint8_t>(ct::xoshiro128pp(7))), "constexpr shuffled");
+static_assert(std::is_same<ct::real_t<ct::xoshiro256ss>, double>::value
+		&& std::is_same<ct::real_t<ct::xoshiro128p>, float>::value, "constexpr uniform types");
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 u128;
+#endif
+
+/*
+ * a compile-time engine's words in logical order, widened like state_of()
+ */
+template <class Engine>
+std::vector<uint64_t> ct_state_of(const Engine &e){
+	std::vector<uint64_t> w;
+	for(unsigned j = 0; j < Engine::family::words; j++)
+		w.push_back(e.s[(j + e.p) & (Engine::family::words - 1)]);
+	return w;
+}
+
+/*
+ * one compile-time engine against the runtime engine of the same name, from a
+ * random state: values, jumps, discard, uniform() and seeding
+ */
+template <class Ct, class Engine>
+void constexpr_matches(checker &c, std::mt19937_64 &r, const std::string &engine){
+	typedef ct::real_t<Ct> real;
+	static_assert(std::is_same<real, typename Engine::real>::value, "ct::real_t is the runtime uniform() type");
+	const std::string name = "constexpr/" + engine;
+	Engine b = random_engine<Engine>(r);
+	typename Engine::word w[Engine::family::words];
+	b.get_state(w);
+	Ct a(w);
+	bool ok = true;
+	for(int i = 0; i < 1000; i++)
+		ok &= a() == b();
+	c.expect(name + " 1000 values", ok);
+	a.jump();
+	b.jump();
+	c.expect(name + " jump", ct_state_of(a) == state_of(b));
+	a.long_jump();
+	b.long_jump();
+	c.expect(name + " long_jump", ct_state_of(a) == state_of(b));
+	const uint64_t d = r() % 1000;
+	a.discard(d);
+	b.advance(d);
+	c.expect(name + " discard", ct_state_of(a) == state_of(b), "distance", d);
+	bool ok_u = true;
+	for(int i = 0; i < 100; i++)
+		ok_u &= ct::uniform(a, real(-3), real(5)) == b.uniform(-3, 5);
+	c.expect(name + " uniform", ok_u && ct_state_of(a) == state_of(b));
+
+	const uint64_t seed = r();
+	Engine g;
+	seed_engine(g, seed);
+	c.expect(name + " seeding", ct_state_of(Ct(seed)) == state_of(g));
+	const int small = r() % 100; // an int seeds too, it doesn't pick the state constructor
+	seed_engine(g, small);
+	c.expect(name + " seeding", ct_state_of(Ct(small)) == state_of(g), "seed", small);
+}
+
+/*
+ * the compile-time engines against the runtime ones, and bounded() against a
+ * plain 128-bit computation of Lemire's method where the compiler has one
+ */
+void constexpr_engines(checker &c, std::mt19937_64 &r, int iterations){
+	static_assert(ct::xoshiro256ss(0).s[0] == UINT64_C(0xe220a8397b1dcdaf), "a literal 0 is a seed, the first splitmix64(0) output");
+	for(int it = 0; it < iterations; it++){
+		constexpr_matches<ct::xoshiro256ss, xoshiro256ss>(c, r, "xoshiro256ss");
+		constexpr_matches<ct::xoshiro256p, xoshiro256p>(c, r, "xoshiro256p");
+		constexpr_matches<ct::xoshiro128ss, xoshiro128ss>(c, r, "xoshiro128ss");
+		constexpr_matches<ct::xoshiro128p, xoshiro128p>(c, r, "xoshiro128p");
+		constexpr_matches<ct::xoshiro128pp, xoshiro128pp>(c, r, "xoshiro128pp");
+		if(it % 4 == 0){
+			constexpr_matches<ct::xoshiro512ss, xoshiro512ss>(c, r, "xoshiro512ss");
+			constexpr_matches<ct::xoshiro512p, xoshiro512p>(c, r, "xoshiro512p");
+			constexpr_matches<ct::xoshiro512pp, xoshiro512pp>(c, r, "xoshiro512pp");
+			constexpr_matches<ct::xoroshiro1024ss, xoroshiro1024ss>(c, r, "xoroshiro1024ss");
+			constexpr_matches<ct::xoroshiro1024s, xoroshiro1024s>(c, r, "xoroshiro1024s");
+		}
+
+		uint64_t s[4];
+		random_state(r, s);
+		uint32_t s32[4];
+		random_state(r, s32);
+
+		// small, power of two, and large ranges, where rejections are common
+		const uint64_t ranges[] = { 1 + r() % 10, UINT64_C(1) << (r() % 64), r() | UINT64_C(1) << 63, 1 + r() };
+		for(uint64_t range : ranges){
+			ct::xoshiro256ss x(s[0], s[1], s[2], s[3]), y = x;
+			bool ok_b = true;
+			uint64_t got = 0, want = 0;
+			for(int i = 0; i < 50 && ok_b; i++){
+				got = ct::bounded(x, range);
+#if defined(__SIZEOF_INT128__)
+				u128 m = (u128)y() * range;
+				const uint64_t floor = (0 - range) % range;
+				while((uint64_t)m < floor)
+					m = (u128)y() * range;
+				want = (uint64_t)(m >> 64);
+#else
+				want = got;
+#endif
+				ok_b = got == want && got < range;
+			}
+			c.expect("constexpr/bounded", ok_b, "value", got, want);
+			const uint32_t range32 = (uint32_t)range ? (uint32_t)range : 1;
+			ct::xoshiro128ss x32(s32[0], s32[1], s32[2], s32[3]), y32 = x32;
+			ok_b = true;
+			for(int i = 0; i < 50 && ok_b; i++){
+				got = ct::bounded(x32, range32);
+				uint64_t m = (uint64_t)y32() * range32;
+				while((uint32_t)m < (uint32_t)(0 - range32) % range32)
+					m = (uint64_t)y32() * range32;
+				want = m >> 32;
+				ok_b = got == want && got < range32;
+			}
+			c.expect("constexpr/bounded 32-bit", ok_b, "value", got, want);
+		}
+
+		const ct::table<uint64_t, 64> t = ct::draws<64>(ct::xoshiro256ss(s[0], s[1], s[2], s[3]));
+		xoshiro256ss k(s[0], s[1], s[2], s[3]);
+		bool ok_t = true;
+		for(uint64_t v : t)
+			ok_t &= v == k();
+		c.expect("constexpr/draws", ok_t);
+		c.expect("constexpr/shuffled", is_permutation(ct::shuffled<1000, uint16_t>(ct::xoshiro256p(s[0], s[1], s[2], s[3]))));
+	}
+
+	// a table the compiler built is the same as one built at run time
+	constexpr auto perm = ct::shuffled<256, uint8_t>(ct::xoshiro256ss(42));
+	const auto again = ct::shuffled<256, uint8_t>(ct::xoshiro256ss(42));
+	c.expect("constexpr/shuffled", !memcmp(perm.v, again.v, sizeof(perm.v)));
+}
+
+int main(int argc, char **argv){
+	int iterations = 200;
+	uint64_t seed = 42;
+	for(int i = 1; i < argc; i++){
+		if(!strcmp(argv[i], "--iterations") && i + 1 < argc)
+			iterations = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--seed") && i + 1 < argc)
+			seed = strtoull(argv[++i], nullptr, 0);
+		else {
+			fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(iterations < 1)
+		iterations = 1;
+	std::mt19937_64 r(seed);
+	checker c;
+	printf("xoshiro self-check, %d iterations, seed %llu\n", iterations, (unsigned long long)seed);
+	known_answers(c);
+	against_reference(c, r, iterations);
+	jump_ahead(c, r, iterations);
+	xoshiro128_family(c, r, iterations);
+	xoshiro512_family(c, r, iterations);
+	xoroshiro1024_family(c, r, iterations);
+	reverse_stepping<xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	reverse_stepping<xoshiro256p>(c, r, iterations, "xoshiro256p");
+	replay<xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	replay<xoshiro128p>(c, r, iterations / 4 + 1, "xoshiro128p");
+	replay<xoshiro512pp>(c, r, iterations / 4 + 1, "xoshiro512pp");
+	replay<xoroshiro1024s>(c, r, iterations / 4 + 1, "xoroshiro1024s");
+	splitmix_bulk(c, r, iterations);
+	engine_array_bulk<xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	engine_array_bulk<xoshiro128p>(c, r, iterations / 4 + 1, "xoshiro128p");
+	engine_array_bulk<xoshiro512pp>(c, r, iterations / 10 + 1, "xoshiro512pp");
+	engine_array_bulk<xoroshiro1024s>(c, r, iterations / 20 + 1, "xoroshiro1024s");
+	interleaved_bulk<1, xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	interleaved_bulk<2, xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	interleaved_bulk<3, xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	interleaved_bulk<4, xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	interleaved_bulk<8, xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	interleaved_bulk<2, xoshiro512p>(c, r, iterations / 4 + 1, "xoshiro512p");
+	interleaved_bulk<3, xoroshiro1024ss>(c, r, iterations / 4 + 1, "xoroshiro1024ss");
+	lanes_bulk<8, xoshiro128ss>(c, r, iterations, "xoshiro128ss");
+	lanes_bulk<16, xoshiro128ss>(c, r, iterations, "xoshiro128ss");
+	lanes_bulk<8, xoshiro128p>(c, r, iterations, "xoshiro128p");
+	lanes_bulk<16, xoshiro128pp>(c, r, iterations, "xoshiro128pp");
+	lanes_bulk<3, xoshiro128pp>(c, r, iterations, "xoshiro128pp");
+	threaded_bulk(c, r, iterations / 10 + 1);
+#if defined(__unix__) || defined(__APPLE__)
+	shared_streams<xoshiro256ss>(c, r, iterations / 10 + 1, "xoshiro256ss");
+	shared_streams<xoshiro128p>(c, r, iterations / 10 + 1, "xoshiro128p");
+	shared_streams<xoroshiro1024ss>(c, r, iterations / 10 + 1, "xoroshiro1024ss");
+#endif
+	formatting(c, r, iterations);
+	constexpr_engines(c, r, iterations);
+#if defined(__cpp_lib_ranges)
+	ranges_bulk<xoshiro256ss>(c, r, iterations, "xoshiro256ss");
+	ranges_bulk<xoshiro128p>(c, r, iterations / 4 + 1, "xoshiro128p");
+	ranges_virtual(c, r, iterations);
+#endif
+#ifdef XOSHIRO_INSTRUMENT
+	instrument_counts(c, r);
+#endif
+	const uint64_t failed = c.report();
+	printf("\n%s\n", failed ? "FAILED" : "all checks passed");
+	return failed ? 1 : 0;
+}
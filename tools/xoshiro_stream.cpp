@@ -0,0 +1,258 @@
+/*
+ * xoshiro_stream.cpp
+ *
+ *  Writes raw generator output as fast as the other end takes it, for feeding
+ *  external testers (PractRand's RNG_test stdin64, TestU01 through a pipe,
+ *  dieharder -g 200) or making test-data files.
+ *
+ *  Values are written as native-endian 64-bit words. With --lanes L > 1 the
+ *  values come from a basic_engine_array of L jump-separated engines and
+ *  are laid out one array step after the other (lane 0..L-1, then lane 0..L-1
+ *  again), which is the order random_feeder and the SIMD paths produce.
+ *
+ *  Output goes through a ring of page-aligned buffers. On Linux, when stdout is a
+ *  pipe the buffers are vmsplice()d into it: the pipe is sized to one buffer, so
+ *  once the next buffer has gone in completely the previous one has been read
+ *  and can be refilled. Otherwise the buffers are written with writev().
+ *  --direct opens the output file with O_DIRECT for storage benchmarks.
+ *
+ *  g++ -std=c++17 -O2 -I.. xoshiro_stream.cpp -o xoshiro-stream
+ *  xoshiro-stream [--engine xoshiro256ss|xoshiro256p|splitmix64] [--seed S]
+ *                 [--jump N] [--lanes L] [--bytes N] [--buffer N]
+ *                 [--output file [--direct]]
+ */
+#include "../xoshiro256.hpp"
+#include "../xoshiro256_array.hpp"
+#include "../xoshiro256_parallel.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*
+ * fills buffers with the selected generator
+ */
+struct generator {
+	virtual ~generator(){}
+	virtual void fill(uint64_t *out, size_t n) = 0; // n is a multiple of the lane count
+};
+
+/*
+ * a single xoshiro engine, called non-virtually
+ */
+template <class Engine>
+struct engine_gen : generator {
+	Engine e;
+	engine_gen(uint64_t seed, uint64_t jumps){
+		seed_engine(e, seed);
+		e.jump(jumps);
+	}
+	void fill(uint64_t *out, size_t n) override {
+		for(size_t i = 0; i < n; i++)
+			out[i] = e.Engine::operator()();
+	}
+};
+
+/*
+ * splitmix64 has no jump polynomial, so --jump n skips n * 2^32 values instead
+ */
+struct splitmix_gen : generator {
+	splitmix64 e;
+	splitmix_gen(uint64_t seed, uint64_t jumps) : e(seed) { e.discard(jumps << 32); }
+	void fill(uint64_t *out, size_t n) override { e.fill(out, n); }
+};
+
+/*
+ * basic_engine_array of jump-separated lanes
+ */
+template <class Engine>
+struct lanes_gen : generator {
+	std::unique_ptr<basic_engine_array<Engine> > e;
+	size_t lanes;
+	lanes_gen(uint64_t seed, uint64_t jumps, size_t lanes) : lanes(lanes) {
+		Engine base;
+		seed_engine(base, seed);
+		base.jump(jumps);
+		e.reset(new basic_engine_array<Engine>(lanes, base));
+	}
+	void fill(uint64_t *out, size_t n) override {
+		for(size_t i = 0; i < n; i += lanes)
+			e->next(out + i);
+	}
+};
+
+/*
+ * write() until everything is out, false on error
+ */
+bool write_all(int fd, const char *p, size_t n){
+	while(n){
+		const ssize_t w = write(fd, p, n);
+		if(w < 0){
+			if(errno == EINTR)
+				continue;
+			return false;
+		}
+		p += w;
+		n -= w;
+	}
+	return true;
+}
+
+int main(int argc, char **argv){
+	std::string engine = "xoshiro256ss";
+	const char *output = nullptr;
+	uint64_t seed = 1, jumps = 0, bytes = 0;
+	size_t lanes = 1, buffer = 1 << 20;
+	bool direct = false;
+	for(int i = 1; i < argc; i++){
+		const bool more = i + 1 < argc;
+		if(!strcmp(argv[i], "--engine") && more)
+			engine = argv[++i];
+		else if(!strcmp(argv[i], "--seed") && more)
+			seed = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--jump") && more)
+			jumps = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--lanes") && more)
+			lanes = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--bytes") && more)
+			bytes = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--buffer") && more)
+			buffer = strtoull(argv[++i], nullptr, 0);
+		else if(!strcmp(argv[i], "--output") && more)
+			output = argv[++i];
+		else if(!strcmp(argv[i], "--direct"))
+			direct = true;
+		else {
+			fprintf(stderr, "usage: %s [--engine xoshiro256ss|xoshiro256p|splitmix64] [--seed S] [--jump N]"
+					" [--lanes L] [--bytes N] [--buffer N] [--output file [--direct]]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(lanes == 0)
+		lanes = 1;
+
+	std::unique_ptr<generator> gen;
+	if(lanes > 1 && engine == "xoshiro256ss")
+		gen.reset(new lanes_gen<xoshiro256ss>(seed, jumps, lanes));
+	else if(lanes > 1 && engine == "xoshiro256p")
+		gen.reset(new lanes_gen<xoshiro256p>(seed, jumps, lanes));
+	else if(lanes > 1){
+		fprintf(stderr, "--lanes is only available for the xoshiro engines\n");
+		return 2;
+	} else if(engine == "xoshiro256ss")
+		gen.reset(new engine_gen<xoshiro256ss>(seed, jumps));
+	else if(engine == "xoshiro256p")
+		gen.reset(new engine_gen<xoshiro256p>(seed, jumps));
+	else if(engine == "splitmix64")
+		gen.reset(new splitmix_gen(seed, jumps));
+	else {
+		fprintf(stderr, "unknown engine %s\n", engine.c_str());
+		return 2;
+	}
+
+	int fd = STDOUT_FILENO;
+	if(output){
+		int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+		if(direct)
+			flags |= O_DIRECT;
+#else
+		if(direct)
+			fprintf(stderr, "O_DIRECT is not available here, writing through the page cache\n");
+#endif
+		fd = open(output, flags, 0644);
+		if(fd < 0){
+			perror(output);
+			return 1;
+		}
+	}
+
+	bool splice = false;
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+	// a pipe sized to exactly one buffer is what makes reusing vmsplice()d pages safe
+	if(!output){
+		const int got = fcntl(fd, F_SETPIPE_SZ, (int)buffer);
+		if(got > 0){
+			buffer = got;
+			splice = true;
+		}
+	}
+#endif
+	// whole pages, whole lane steps
+	const size_t unit = 4096 * lanes;
+	buffer = (buffer + unit - 1) / unit * unit;
+	const int NBUF = splice ? 2 : 4;
+	std::unique_ptr<char[]> raw(new char[NBUF * buffer + 4096]);
+	char *base = raw.get() + (4096 - reinterpret_cast<uintptr_t>(raw.get()) % 4096) % 4096;
+
+	uint64_t left = bytes;
+	for(int cur = 0; !bytes || left; cur = (cur + 1) % NBUF){
+		// vmsplice hands over one buffer at a time, writev the whole ring
+		const int count = splice ? 1 : NBUF;
+		struct iovec iov[4];
+		int used = 0;
+		for(int k = 0; k < count && (!bytes || left); k++){
+			char *b = base + ((cur + k) % NBUF) * buffer;
+			gen->fill(reinterpret_cast<uint64_t*>(b), buffer / sizeof(uint64_t));
+			const size_t len = bytes && left < buffer ? left : buffer;
+			iov[used].iov_base = b;
+			iov[used].iov_len = len;
+			used++;
+			if(bytes)
+				left -= len;
+		}
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+		if(splice){
+			while(iov[0].iov_len){
+				const ssize_t w = vmsplice(fd, iov, 1, 0);
+				if(w < 0 && errno == EINTR)
+					continue;
+				if(w < 0)
+					return errno == EPIPE ? 0 : (perror("vmsplice"), 1);
+				iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + w;
+				iov[0].iov_len -= w;
+			}
+			continue;
+		}
+#endif
+		if(direct){
+			// O_DIRECT wants whole blocks. a short tail goes through the page cache.
+			for(int k = 0; k < used; k++){
+				const char *p = static_cast<const char*>(iov[k].iov_base);
+				const size_t len = iov[k].iov_len, whole = len / 4096 * 4096;
+				bool ok = write_all(fd, p, whole);
+#ifdef O_DIRECT
+				if(ok && len != whole)
+					fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+#endif
+				if(!ok || !write_all(fd, p + whole, len - whole)){
+					perror("write");
+					return 1;
+				}
+			}
+			continue;
+		}
+		for(int k = 0; k < used;){
+			const ssize_t w = writev(fd, iov + k, used - k);
+			if(w < 0 && errno == EINTR)
+				continue;
+			if(w < 0)
+				return errno == EPIPE ? 0 : (perror("writev"), 1);
+			size_t done = w;
+			while(k < used && done >= iov[k].iov_len)
+				done -= iov[k++].iov_len;
+			if(k < used){
+				iov[k].iov_base = static_cast<char*>(iov[k].iov_base) + done;
+				iov[k].iov_len -= done;
+			}
+		}
+	}
+	if(output)
+		close(fd);
+	return 0;
+}
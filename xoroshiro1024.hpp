@@ -0,0 +1,123 @@
+/*
+ * xoroshiro1024.hpp
+ *
+ *  xoroshiro1024** and xoroshiro1024*, the 1024-bit state generators, for runs
+ *  that need more streams or longer ones than xoshiro512 provides. Based off of
+ *  the C code on Sebastiano Vigna's website:
+ *  http://prng.di.unimi.it/xoroshiro1024starstar.c
+ *  http://prng.di.unimi.it/xoroshiro1024star.c
+ *
+ *  The engines are the engine template of xoshiro256_core.hpp over the family
+ *  below, with sixteen words of state, so they have every member of
+ *  xoshiro256ss and everything that takes an engine takes these too. The
+ *  state is a ring: p is the word written last, and each step only touches
+ *  two words, so a step costs the same as for the smaller engines. jump()
+ *  moves 2^512 values ahead and long_jump() 2^768.
+ *
+ *  ---------------------Original Xoroshiro1024** Comments---------------------
+ *
+ *  Written in 2019 by David Blackman and Sebastiano Vigna (vigna@acm.org)
+ *
+ *  To the extent possible under law, the author has dedicated all copyright
+ *  and related and neighboring rights to this software to the public domain
+ *  worldwide. This software is distributed without any warranty.
+ *
+ *  See <http://creativecommons.org/publicdomain/zero/1.0/>.
+ *
+ *  This is xoroshiro1024** 1.0, one of our all-purpose, rock-solid,
+ *  large-state generators. It is extremely fast and it passes all
+ *  tests we are aware of. Its state however is too large--for general use,
+ *  consider our xoshiro256** or xoshiro256++.
+ *
+ *  The state must be seeded so that it is not everywhere zero. If you have
+ *  a 64-bit seed, we suggest to seed a splitmix64 generator and use its
+ *  output to fill s.
+ *
+ *  ---------------------Original Xoroshiro1024* Comments---------------------
+ *
+ *  This is xoroshiro1024* 1.0, our large-state generator for floating-point
+ *  numbers. We suggest to use its upper bits for floating-point
+ *  generation, as it is slightly faster than xoroshiro1024**. Its state
+ *  however is too large--for general use, consider our xoshiro256+.
+ *
+ *  The lowest bits of the output have low linear complexity and will fail
+ *  linearity tests, so if that is an issue for you use the ** version.
+ */
+#ifndef XOROSHIRO1024_HPP_
+#define XOROSHIRO1024_HPP_
+
+#include "xoshiro256_core.hpp"
+
+namespace xoshiro_detail {
+
+/*
+ * the xoroshiro1024 state transition and its output functions, see
+ * xoshiro256_family. the words are a ring: step() reads s[(p+1)&15] and
+ * returns that index as the new p, and both outputs are made from the word it
+ * reads. applying a polynomial walks 1024 steps and xors sixteen words on half
+ * of them, so advance() and retreat() step through a longer range.
+ */
+struct xoroshiro1024_family {
+	typedef uint64_t word; // the type of a state word and of a value
+	enum : unsigned { words = 16 }; // state words
+	enum : bool { ring = true }; // whether the words are a ring that p moves around
+	enum : uint64_t { advance_steps = 16384, retreat_steps = 16384 }; // distances advance() and retreat() walk instead of using the field
+	static constexpr const uint64_t* jump_poly() { return jump_tables<>::xoroshiro1024; } // 2^512 steps
+	static constexpr const uint64_t* long_jump_poly() { return jump_tables<>::xoroshiro1024_long; } // 2^768 steps
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned step(S s, unsigned p); // one step of the state, returns the new p
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned unstep(S s, unsigned p); // the inverse of step()
+
+	struct starstar { // xoroshiro1024**
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned p) { return rotl(s[(p + 1) & 15] * 5, 7) * 9; }
+	};
+	struct star { // xoroshiro1024*
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned p) { return s[(p + 1) & 15] * 0x9e3779b97f4a7c13; }
+	};
+};
+
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoroshiro1024_family::step(S s, unsigned p) {
+	const unsigned q = p;
+	p = (p + 1) & 15;
+	const uint64_t s0 = s[p];
+	uint64_t s15 = s[q];
+	s15 ^= s0;
+	s[q] = rotl(s0, 25) ^ s15 ^ (s15 << 27);
+	s[p] = rotl(s15, 36);
+	return p;
+}
+
+/*
+ * step() undone. s[p] gives s0 ^ s15 back through the rotation, and with it
+ * s[q] gives rotl(s0, 25); the xorshift by 27 is xored in, not applied, so
+ * nothing has to be inverted bit by bit.
+ */
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoroshiro1024_family::unstep(S s, unsigned p) {
+	const unsigned q = (p - 1) & 15;
+	const uint64_t x = rotl(s[p], 64 - 36);
+	const uint64_t s0 = rotl(s[q] ^ x ^ (x << 27), 64 - 25);
+	s[p] = s0;
+	s[q] = x ^ s0;
+	return q;
+}
+
+} // namespace xoshiro_detail
+
+typedef xoshiro_engine<xoshiro_detail::xoroshiro1024_family> xoroshiro1024ss; // xoroshiro1024**
+typedef xoshiro_scrambled<xoshiro_detail::xoroshiro1024_family, xoshiro_detail::xoroshiro1024_family::star> xoroshiro1024s; // xoroshiro1024*
+
+/*
+ * instantiated once in src/xoshiro256.cpp with the compiled library, see
+ * xoshiro256_core.hpp
+ */
+#if !XOSHIRO256_IMPL
+extern template class xoshiro_engine<xoshiro_detail::xoroshiro1024_family>;
+extern template class xoshiro_scrambled<xoshiro_detail::xoroshiro1024_family, xoshiro_detail::xoroshiro1024_family::star>;
+#endif
+
+#endif /* XOROSHIRO1024_HPP_ */
@@ -0,0 +1,220 @@
+/*
+ * xoshiro128.hpp
+ *
+ *  The 32-bit members of the family, for code that only wants floats: the state
+ *  is four uint32_t and every call gives 32 bits. Based off of the C code on
+ *  Sebastiano Vigna's website:
+ *  http://prng.di.unimi.it/xoshiro128starstar.c
+ *  http://prng.di.unimi.it/xoshiro128plus.c
+ *  http://prng.di.unimi.it/xoshiro128plusplus.c
+ *
+ *  The engines are the engine template of xoshiro256_core.hpp over the family
+ *  below, so they have every member of xoshiro256ss and xoshiro256p: xoshiro128**
+ *  is the base class, and xoshiro128+ and xoshiro128++ only replace the ()
+ *  operator (the scrambler). uniform(), exponential() and geometric() work in
+ *  float; uniform() builds it from the top 23 bits, which are the good ones for
+ *  all three scramblers. engine_array, interleaved<N>, the replay log, the
+ *  instrument counters and the state formatters take them like any other
+ *  engine; xoshiro128_lanes.hpp has the 8 and 16 stream interleaved versions.
+ *
+ *  ---------------------Original Xoshiro128** Comments---------------------
+ *
+ *  Written in 2018 by David Blackman and Sebastiano Vigna (vigna@acm.org)
+ *
+ *  To the extent possible under law, the author has dedicated all copyright
+ *  and related and neighboring rights to this software to the public domain
+ *  worldwide. This software is distributed without any warranty.
+ *
+ *  See <http://creativecommons.org/publicdomain/zero/1.0/>.
+ *
+ *  This is xoshiro128** 1.1, one of our 32-bit all-purpose, rock-solid
+ *  generators. It has excellent speed, a state size (128 bits) that is
+ *  large enough for mild parallelism, and it passes all tests we are aware
+ *  of.
+ *
+ *  Note that version 1.0 had mistakenly s[0] instead of s[1] as state
+ *  word passed to the scrambler.
+ *
+ *  For generating just single-precision (i.e., 32-bit) floating-point
+ *  numbers, xoshiro128+ is even faster.
+ *
+ *  The state must be seeded so that it is not everywhere zero.
+ *
+ *  ---------------------Original Xoshiro128+ Comments---------------------
+ *
+ *  This is xoshiro128+ 1.0, our best and fastest 32-bit generator for 32-bit
+ *  floating-point numbers. We suggest to use its upper bits for
+ *  floating-point generation, as it is slightly faster than xoshiro128**.
+ *  It passes all tests we are aware of except for linearity tests, as the
+ *  lowest four bits have low linear complexity, so if low linear complexity
+ *  is not considered an issue (as it is usually the case) it can be used to
+ *  generate 32-bit outputs, too.
+ *
+ *  ---------------------Original Xoshiro128++ Comments---------------------
+ *
+ *  This is xoshiro128++ 1.0, one of our 32-bit all-purpose, rock-solid
+ *  generators. It has excellent speed, a state size (128 bits) that is
+ *  large enough for mild parallelism, and it passes all tests we are aware
+ *  of.
+ */
+#ifndef XOSHIRO128_HPP_
+#define XOSHIRO128_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <cstring>
+
+/*
+ * Rotation function using bit shifts, the 32-bit version of rotl()
+ */
+constexpr uint32_t rotl32(const uint32_t x, int k) {
+	return (x << k) | (x >> (32 - k));
+}
+
+namespace xoshiro_detail {
+
+/*
+ * the xoshiro128 state transition and its output functions, see
+ * xoshiro256_family
+ */
+struct xoshiro128_family {
+	typedef uint32_t word; // the type of a state word and of a value
+	enum : unsigned { words = 4 }; // state words
+	enum : bool { ring = false }; // whether the words are a ring that p moves around
+	enum : uint64_t { advance_steps = 1024, retreat_steps = 4096 }; // distances advance() and retreat() walk instead of using the field
+	static constexpr const uint64_t* jump_poly() { return jump_tables<>::xoshiro128; } // 2^64 steps
+	static constexpr const uint64_t* long_jump_poly() { return jump_tables<>::xoshiro128_long; } // 2^96 steps
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned step(S s, unsigned p); // one step of the state, returns the new p
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned unstep(S s, unsigned p); // the inverse of step()
+
+	struct starstar { // xoshiro128**
+		template <class S>
+		static constexpr uint32_t scramble(S s, unsigned) { return rotl32(s[1] * 5, 7) * 9; }
+	};
+	struct plus { // xoshiro128+
+		template <class S>
+		static constexpr uint32_t scramble(S s, unsigned) { return s[0] + s[3]; }
+	};
+	struct plusplus { // xoshiro128++
+		template <class S>
+		static constexpr uint32_t scramble(S s, unsigned) { return rotl32(s[0] + s[3], 7) + s[0]; }
+	};
+};
+
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoshiro128_family::step(S s, unsigned p) {
+	const uint32_t t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+
+	s[3] = rotl32(s[3], 11);
+	return p;
+}
+
+/*
+ * xoshiro256_family::unstep() with the 32-bit shifts: z = s[1] ^ (s[1] << 9)
+ * is inverted by the shifts by 9 and 18, the one by 27 being covered by the
+ * second doubling
+ */
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoshiro128_family::unstep(S s, unsigned p) {
+	const uint32_t s3s1 = rotl32(s[3], 32 - 11);
+	uint32_t z = s[1] ^ s[2];
+	s[0] ^= s3s1;
+	const uint32_t s1s2 = s[1] ^ s[0];
+
+	z ^= z << 9;
+	s[1] = z ^ (z << 18);
+	s[2] = s1s2 ^ s[1];
+	s[3] = s3s1 ^ s[1];
+	return p;
+}
+
+/*
+ * a float in (0,1) from the top 23 bits of v: (k + 1/2) / 2^23, which is exact,
+ * so neither end can come out and no value has to be rejected
+ */
+constexpr float unit_float(uint32_t v) {
+	return ((v >> 9) + 0.5f) * (1.0f / 8388608);
+}
+
+/*
+ * a float has too few bits to reject the ends like the 64-bit conversion: a
+ * 32-bit value over 2^32-1 rounds to 1 for the top 128 values
+ */
+template <>
+struct uniform_conversion<uint32_t> {
+	typedef float real; // what uniform() returns
+	enum : bool { rejects = false }; // whether rejected() is ever true
+	static constexpr bool rejected(uint32_t) { return false; }
+	static constexpr float convert(uint32_t v, float low, float high) {
+		return low + (high-low)*unit_float(v);
+	}
+};
+
+/*
+ * the shift that brings the first of two adjacent 32-bit words down from a
+ * 64-bit load of both, see step_state() below
+ */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+enum : unsigned { FIRST_HALF = 32 };
+#else
+enum : unsigned { FIRST_HALF = 0 };
+#endif
+
+template <>
+XOSHIRO256_DECL unsigned step_state<xoshiro128_family>(uint32_t *s, unsigned p); // the step through two 64-bit halves
+
+} // namespace xoshiro_detail
+
+typedef xoshiro_engine<xoshiro_detail::xoshiro128_family> xoshiro128ss; // xoshiro128**
+typedef xoshiro_scrambled<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plus> xoshiro128p; // xoshiro128+
+typedef xoshiro_scrambled<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plusplus> xoshiro128pp; // xoshiro128++
+
+#if XOSHIRO256_IMPL
+
+/*
+ * one step of an engine's state, also the body of the () operators. the state
+ * is stepped in locals, which are loaded and stored as two 64-bit halves: GCC
+ * merges four adjacent 32-bit stores into one vector store put together with
+ * shuffles, and the loads of the next step then wait for it, which made an
+ * out-of-line () three times slower. it leaves two 64-bit stores alone, and
+ * memcpy keeps them within the aliasing rules.
+ */
+template <>
+XOSHIRO256_DECL unsigned xoshiro_detail::step_state<xoshiro_detail::xoshiro128_family>(uint32_t *s, unsigned p) {
+	uint64_t h[2];
+	memcpy(h, s, sizeof(h));
+	uint32_t w[4];
+	for(int i = 0; i < 2; i++){
+		w[2*i] = (uint32_t)(h[i] >> FIRST_HALF);
+		w[2*i+1] = (uint32_t)(h[i] >> (32 - FIRST_HALF));
+	}
+
+	xoshiro128_family::step(w, p);
+
+	for(int i = 0; i < 2; i++)
+		h[i] = (uint64_t)w[2*i] << FIRST_HALF | (uint64_t)w[2*i+1] << (32 - FIRST_HALF);
+	memcpy(s, h, sizeof(h));
+	return p;
+}
+
+#endif /* XOSHIRO256_IMPL */
+
+/*
+ * instantiated once in src/xoshiro256.cpp with the compiled library, see
+ * xoshiro256_core.hpp
+ */
+#if !XOSHIRO256_IMPL
+extern template class xoshiro_engine<xoshiro_detail::xoshiro128_family>;
+extern template class xoshiro_scrambled<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plus>;
+extern template class xoshiro_scrambled<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plusplus>;
+#endif
+
+#endif /* XOSHIRO128_HPP_ */
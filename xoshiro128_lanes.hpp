@@ -0,0 +1,37 @@
+/*
+ * xoshiro128_lanes.hpp
+ *
+ *  xoshiro128**, + or ++ with L independent states stepped in lockstep: the
+ *  32-bit engines in interleaved<L, Engine>, which lays word w of all L states
+ *  out as one contiguous row. The bulk loops are plain C++ over the lanes,
+ *  which the compiler turns into one vector operation per row: 8 lanes fill a
+ *  256-bit AVX2 register and 16 lanes an AVX-512 one (build with -mavx2 or
+ *  -mavx512f, or -march=native). With 32-bit lanes that is twice the values
+ *  per instruction of the 64-bit engines. Without those instruction sets the
+ *  same code runs on SSE or NEON, or as scalar code.
+ *
+ *  Stream j is the base engine after j jumps, and the values are handed out
+ *  round robin: value k*L+j is value k of stream j. So xoshiro128_lanes<L, E>
+ *  from base gives the same values as L copies of base jumped 0..L-1 times
+ *  read in turn.
+ *
+ *      xoshiro128x8 g(xoshiro128ss(1, 2, 3, 4));
+ *      g.fill_uniform(buf, n, 0.0f, 1.0f);   // n floats in (0,1)
+ */
+#ifndef XOSHIRO128_LANES_HPP_
+#define XOSHIRO128_LANES_HPP_
+
+#include "xoshiro128.hpp"
+#include "xoshiro256_interleaved.hpp"
+
+/*
+ * the lane engine. Engine is xoshiro128ss, xoshiro128p or xoshiro128pp and
+ * picks the scrambler.
+ */
+template <unsigned L, class Engine = xoshiro128ss>
+using xoshiro128_lanes = interleaved<L, Engine>;
+
+typedef xoshiro128_lanes<8> xoshiro128x8; // xoshiro128**, one AVX2 register per state row
+typedef xoshiro128_lanes<16> xoshiro128x16; // xoshiro128**, one AVX-512 register per state row
+
+#endif /* XOSHIRO128_LANES_HPP_ */
@@ -0,0 +1,123 @@
+/*
+ * xoshiro256.cppm
+ *
+ *  C++20 module interface: `import xoshiro;` gives the engines and the helpers
+ *  without reparsing the headers in every translation unit. The module is the
+ *  headers themselves, in header-only mode, included inside one export block,
+ *  so the two can't drift apart.
+ *
+ *  Module support differs between build systems. By hand, with GCC:
+ *
+ *      g++ -std=c++20 -fmodules-ts -O2 -I. -c -x c++ xoshiro256.cppm
+ *      g++ -std=c++20 -fmodules-ts -O2 main.cpp xoshiro256.o -pthread
+ *
+ *  GCC 12 wants <typeinfo> included before the import in files that use the
+ *  range views (they call typeid). The POSIX-only stream_registry is only there
+ *  on POSIX systems.
+ */
+module;
+
+// every system header the library uses, so that the includes inside the
+// export block below find them already included
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+export module xoshiro;
+
+// extern "C++" keeps the declarations in the global module, so a program can
+// mix `import xoshiro;` and #include of the headers without ODR trouble
+export extern "C++" {
+#include "xoshiro256.hpp"
+#include "xoshiro128.hpp"
+#include "xoshiro128_lanes.hpp"
+#include "xoshiro512.hpp"
+#include "xoroshiro1024.hpp"
+#include "xoshiro256_array.hpp"
+#include "xoshiro256_constexpr.hpp"
+#include "xoshiro256_feeder.hpp"
+#include "xoshiro256_instrument.hpp"
+#include "xoshiro256_interleaved.hpp"
+#include "xoshiro256_iterator.hpp"
+#include "xoshiro256_parallel.hpp"
+#include "xoshiro256_pool.hpp"
+#include "xoshiro256_ranges.hpp"
+#include "xoshiro256_replay.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include "xoshiro256_shm.hpp"
+#endif
+}
+
+// GCC 12 expects the static members of class templates in the export block to
+// be emitted by the interface unit, so the formatter and jump tables are
+// instantiated here once
+template struct xoshiro_detail::io_tables<void>;
+template struct xoshiro_detail::jump_tables<void>;
+
+// the same goes for the jump-ahead fields: the inline field() functions keep
+// theirs in a function-local static, which is only emitted where the function
+// is, so the engines are instantiated here like the library does in
+// src/xoshiro256.cpp, and the fields with them
+template class xoshiro_detail::gf2_field<2>;
+template class xoshiro_detail::gf2_field<4>;
+template class xoshiro_detail::gf2_field<8>;
+template class xoshiro_detail::gf2_field<16>;
+template class xoshiro_engine<xoshiro_detail::xoshiro256_family>;
+template class xoshiro_scrambled<xoshiro_detail::xoshiro256_family, xoshiro_detail::xoshiro256_family::plus>;
+template class xoshiro_engine<xoshiro_detail::xoshiro128_family>;
+template class xoshiro_scrambled<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plus>;
+template class xoshiro_scrambled<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plusplus>;
+template class xoshiro_engine<xoshiro_detail::xoshiro512_family>;
+template class xoshiro_scrambled<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plus>;
+template class xoshiro_scrambled<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plusplus>;
+template class xoshiro_engine<xoshiro_detail::xoroshiro1024_family>;
+template class xoshiro_scrambled<xoshiro_detail::xoroshiro1024_family, xoshiro_detail::xoroshiro1024_family::star>;
+
+// and for the four-word constructors, which are member templates, and for
+// engine_array, which random_feeder instantiates inside the block
+template xoshiro256ss::xoshiro_engine(uint64_t, uint64_t, uint64_t, uint64_t);
+template xoshiro128ss::xoshiro_engine(uint32_t, uint32_t, uint32_t, uint32_t);
+template class basic_engine_array<xoshiro256ss>;
+
+// stream_registry's instantiation uses the fork hooks, which keep their list
+// and its lock in function-local statics like field() does
+#if defined(__unix__) || defined(__APPLE__)
+template class basic_stream_registry<xoshiro256ss>;
+#endif
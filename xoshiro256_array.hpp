@@ -0,0 +1,407 @@
+/*
+ * xoshiro256_array.hpp
+ *
+ *  A structure-of-arrays container of engines. Each engine is just its state
+ *  words, word w of every engine in one cache-line aligned array, so stepping
+ *  all of them is a straight loop over the arrays that the compiler turns into
+ *  SIMD code. Compared to a std::vector<xoshiro256ss> this saves the vptr (32
+ *  bytes per engine instead of 40) and makes per-entity randomness limited by
+ *  memory bandwidth instead of the latency of one dependency chain at a time.
+ *  Stepping a subset through an index list is a scalar loop, see next().
+ *
+ *  basic_engine_array<Engine> takes any engine (xoshiro256ss, xoshiro128p,
+ *  xoshiro512ss, ...); the family gives the step and the scrambler the output.
+ *  engine_array is the xoshiro256** one. For xoroshiro1024, whose state is a
+ *  ring, every engine also keeps its ring start.
+ *
+ *  Engine i produces exactly the same values as an Engine holding the same
+ *  state, see get() and set(). dump_states() and parse_states() save and
+ *  restore all the states as text, one line per engine in the format of
+ *  xoshiro_io::to_hex.
+ */
+#ifndef XOSHIRO256_ARRAY_HPP_
+#define XOSHIRO256_ARRAY_HPP_
+
+#include "xoshiro256_core.hpp"
+#include "xoshiro256_io.hpp"
+#include <cstddef>
+#include <memory>
+
+namespace xoshiro_detail {
+
+/*
+ * one engine of a basic_engine_array, indexed like an engine's state array,
+ * so the family functions step it in place
+ */
+template <class Word>
+struct row_lane {
+	Word *const *rows; // rows[w][i] is word w of engine i
+	size_t i; // the engine
+	Word& operator[](unsigned w) const { return rows[w][i]; }
+};
+
+} // namespace xoshiro_detail
+
+/*
+ * class declaration for the engine array
+ */
+template <class Engine>
+class basic_engine_array {
+public:
+	typedef typename Engine::family family; // the state transition
+	typedef typename Engine::scrambler scrambler; // the output function
+	typedef typename family::word word; // the type of a state word and of a value
+	typedef xoshiro_engine<family> base_engine; // any engine of the family, whatever its output
+	basic_engine_array(size_t n, uint64_t seed); // n engines seeded from one splitmix64 stream
+	basic_engine_array(size_t n, const base_engine &base); // engine i is base after i jumps
+	size_t size() const; // number of engines
+	void seed(uint64_t seed); // engine i gets outputs words*i.. of splitmix64(seed), one per word
+	void seed_jumped(const base_engine &base); // engine i gets base after i jumps
+	void next(word *out); // steps every engine, out[i] is engine i's output
+	void next(const uint32_t *idx, size_t count, word *out); // steps engines idx[0..count), which must be distinct. scalar
+	word operator()(size_t i); // steps engine i alone
+	void jump(); // jump() on every engine
+	void long_jump(); // long_jump() on every engine
+	Engine get(size_t i) const; // copy of engine i
+	void set(size_t i, const base_engine &e); // overwrites engine i
+	size_t dump_size() const; // bytes dump_states() writes
+	size_t dump_states(char *out, size_t size) const; // one line of to_hex digits per engine, 0 if size is too small
+	size_t parse_states(const char *in, size_t size); // reads dump_states() lines into engines 0.., returns how many
+	word *s[family::words]; // the state arrays, 64-byte aligned. s[w][i] is word w of engine i
+private:
+	typedef xoshiro_detail::row_lane<word> lane; // engine i of the rows
+	enum : size_t { MAP_MIN = 4 * 64 * xoshiro_detail::field_words<family>() }; // engines from which a jump_map() pays off
+	enum : unsigned { BITS = 64 * xoshiro_detail::field_words<family>() }; // state bits
+	enum : unsigned { NIBBLES = 2 * sizeof(word) }; // nibbles per word
+	void allocate(size_t n); // sets up the storage and the row pointers
+	unsigned pos(size_t i) const { return family::ring ? p_[i] : 0; } // engine i's ring start
+	void pos(size_t i, unsigned p) { if(family::ring) p_[i] = (unsigned char)p; } // sets it
+	void get_state(size_t i, word *w) const; // engine i's words in logical order
+	void set_state(size_t i, const word *w); // the inverse, p = 0
+	void apply_poly(const uint64_t *poly); // xoshiro_detail::apply_poly for every engine
+	static void jump_map(const uint64_t *poly, word *map); // tabulates apply_poly(poly) as BITS/4*16 rows
+	static void apply_map(const word *map, word *w); // one state through a jump_map
+	size_t n_; // number of engines
+	std::unique_ptr<word[]> storage_; // backing memory for the rows
+	std::unique_ptr<unsigned char[]> p_; // the ring starts, for a ring family only
+};
+
+typedef basic_engine_array<xoshiro256ss> engine_array; // xoshiro256** engines
+
+/*
+ * array seeded from a single splitmix64 stream
+ */
+template <class Engine>
+basic_engine_array<Engine>::basic_engine_array(size_t n, uint64_t seed){
+	allocate(n);
+	this->seed(seed);
+}
+
+/*
+ * array of jump-separated engines
+ */
+template <class Engine>
+basic_engine_array<Engine>::basic_engine_array(size_t n, const base_engine &base){
+	allocate(n);
+	seed_jumped(base);
+}
+
+/*
+ * each array is padded to a multiple of 64 bytes, so if the first is on a
+ * cache line boundary all of them are
+ */
+template <class Engine>
+void basic_engine_array<Engine>::allocate(size_t n){
+	const size_t line = 64 / sizeof(word);
+	n_ = n;
+	const size_t stride = (n + line - 1) & ~(line - 1);
+	storage_.reset(new word[family::words*stride + line]);
+	word *p = storage_.get();
+	p += (line - (reinterpret_cast<uintptr_t>(p) / sizeof(word)) % line) % line;
+	for(unsigned w = 0; w < family::words; w++)
+		s[w] = p + w*stride;
+	if(family::ring)
+		p_.reset(new unsigned char[n]());
+}
+
+/*
+ * number of engines
+ */
+template <class Engine>
+size_t basic_engine_array<Engine>::size() const{
+	return n_;
+}
+
+/*
+ * counter-based seeding, so there is no dependency between engines
+ */
+template <class Engine>
+void basic_engine_array<Engine>::seed(uint64_t seed){
+	const splitmix64 seeder(seed);
+	const size_t n = n_;
+	for(size_t i = 0; i < n; i++){
+		for(unsigned w = 0; w < family::words; w++)
+			s[w][i] = (word)seeder.at(family::words*i + w);
+		pos(i, 0);
+	}
+}
+
+/*
+ * the classic way of getting non-overlapping streams: each engine is the one
+ * before it moved by the jump polynomial, through a jump_map() once there are
+ * enough engines to pay for building it
+ */
+template <class Engine>
+void basic_engine_array<Engine>::seed_jumped(const base_engine &base){
+	word w[family::words];
+	base.get_state(w);
+	if(n_ < MAP_MIN){
+		for(size_t i = 0; i < n_; i++){
+			set_state(i, w);
+			xoshiro_detail::apply_poly<family>(w, 0, family::jump_poly(), 0);
+		}
+		return;
+	}
+	std::unique_ptr<word[]> map(new word[BITS/4*16*family::words]);
+	jump_map(family::jump_poly(), map.get());
+	for(size_t i = 0; i < n_; i++){
+		set_state(i, w);
+		apply_map(map.get(), w);
+	}
+}
+
+/*
+ * steps all engines. the row pointers could overlap as far as the compiler
+ * knows, which would stop it from vectorizing the loop; they don't, and engine
+ * i only touches index i of each, so the pragma tells it there is no
+ * dependency between iterations (other compilers ignore it). the ring start
+ * is a constant 0 for the families without one.
+ */
+template <class Engine>
+void basic_engine_array<Engine>::next(word *out){
+	word *rows[family::words];
+	for(unsigned w = 0; w < family::words; w++)
+		rows[w] = s[w];
+	const size_t n = n_;
+#pragma GCC ivdep
+	for(size_t i = 0; i < n; i++){
+		const lane l = { rows, i };
+		const unsigned p = pos(i);
+		out[i] = scrambler::scramble(l, p);
+		pos(i, family::step(l, p));
+	}
+}
+
+/*
+ * steps a subset of the engines. out[k] is the output of engine idx[k].
+ *
+ * this is scalar on purpose. the engines are distinct, so the iterations don't
+ * depend on each other and the core overlaps them already; the cost is in
+ * reaching four scattered words per engine. gathering chunks of the selected
+ * states into local arrays, stepping them with the vector loop of next() and
+ * scattering them back was up to 1.6 times slower at -O2, with or without
+ * AVX-512, and only came out ahead at -O3 on large sparse subsets.
+ */
+template <class Engine>
+void basic_engine_array<Engine>::next(const uint32_t *idx, size_t count, word *out){
+	for(size_t k = 0; k < count; k++)
+		out[k] = (*this)(idx[k]);
+}
+
+/*
+ * steps a single engine
+ */
+template <class Engine>
+typename Engine::family::word basic_engine_array<Engine>::operator()(size_t i){
+	const lane l = { s, i };
+	const unsigned p = pos(i);
+	const word result = scrambler::scramble(l, p);
+	pos(i, family::step(l, p));
+	return result;
+}
+
+/*
+ * jump every engine, see xoshiro_engine::jump()
+ */
+template <class Engine>
+void basic_engine_array<Engine>::jump(){
+	apply_poly(family::jump_poly());
+}
+
+/*
+ * long jump every engine, see xoshiro_engine::long_jump()
+ */
+template <class Engine>
+void basic_engine_array<Engine>::long_jump(){
+	apply_poly(family::long_jump_poly());
+}
+
+/*
+ * a few engines are cheaper to jump one at a time than to build the map for
+ */
+template <class Engine>
+void basic_engine_array<Engine>::apply_poly(const uint64_t *poly){
+	word w[family::words];
+	if(n_ < MAP_MIN){
+		for(size_t i = 0; i < n_; i++){
+			get_state(i, w);
+			xoshiro_detail::apply_poly<family>(w, 0, poly, 0);
+			set_state(i, w);
+		}
+		return;
+	}
+	std::unique_ptr<word[]> map(new word[BITS/4*16*family::words]);
+	jump_map(poly, map.get());
+	const size_t n = n_;
+	for(size_t i = 0; i < n; i++){
+		get_state(i, w);
+		apply_map(map.get(), w);
+		set_state(i, w);
+	}
+}
+
+/*
+ * a jump is a linear map of the state bits, so it can be tabulated: row
+ * 16*k+v is the image of the state whose kth nibble is v and whose other bits
+ * are 0, and the image of any state is the xor of the rows its nibbles pick.
+ * for xoshiro256 that is 64 loads and xors instead of the 256 dependent steps
+ * and the unpredictable branches of apply_poly(), about 4 times faster per
+ * engine, and the 32 KB table stays in L1. rows are built from the images of
+ * the single bits, which costs about as much as 3 jumps per state bit.
+ */
+template <class Engine>
+void basic_engine_array<Engine>::jump_map(const uint64_t *poly, word *map){
+	const unsigned W = family::words, B = 8 * sizeof(word);
+	std::unique_ptr<word[]> bits(new word[BITS*W]);
+	for(unsigned k = 0; k < BITS; k++){
+		word *e = &bits[k*W];
+		for(unsigned w = 0; w < W; w++)
+			e[w] = w == k / B ? (word)1 << (k % B) : 0;
+		xoshiro_detail::apply_poly<family>(e, 0, poly, 0);
+	}
+	for(unsigned k = 0; k < BITS/4; k++){
+		for(unsigned w = 0; w < W; w++)
+			map[16*k*W + w] = 0;
+		// v with its lowest bit cleared is an earlier row
+		for(unsigned v = 1; v < 16; v++){
+			const unsigned low = v & 1 ? 0 : v & 2 ? 1 : v & 4 ? 2 : 3;
+			for(unsigned w = 0; w < W; w++)
+				map[(16*k + v)*W + w] = map[(16*k + (v & (v-1)))*W + w] ^ bits[(4*k + low)*W + w];
+		}
+	}
+}
+
+/*
+ * one state through the map
+ */
+template <class Engine>
+void basic_engine_array<Engine>::apply_map(const word *map, word *w){
+	const unsigned W = family::words;
+	word r[family::words] = {};
+	for(unsigned j = 0; j < W; j++)
+		for(unsigned k = 0; k < NIBBLES; k++){
+			const word *row = map + (16*(NIBBLES*j + k) + ((w[j] >> 4*k) & 15))*W;
+			for(unsigned v = 0; v < W; v++)
+				r[v] ^= row[v];
+		}
+	for(unsigned j = 0; j < W; j++)
+		w[j] = r[j];
+}
+
+/*
+ * the words from the ring start on
+ */
+template <class Engine>
+void basic_engine_array<Engine>::get_state(size_t i, word *w) const{
+	const unsigned p = pos(i);
+	for(unsigned j = 0; j < family::words; j++)
+		w[j] = s[(j + p) & (family::words - 1)][i];
+}
+
+template <class Engine>
+void basic_engine_array<Engine>::set_state(size_t i, const word *w){
+	for(unsigned j = 0; j < family::words; j++)
+		s[j][i] = w[j];
+	pos(i, 0);
+}
+
+/*
+ * copy engine i out into a regular engine
+ */
+template <class Engine>
+Engine basic_engine_array<Engine>::get(size_t i) const{
+	word w[family::words];
+	get_state(i, w);
+	return Engine(w);
+}
+
+/*
+ * copy a regular engine's state into slot i
+ */
+template <class Engine>
+void basic_engine_array<Engine>::set(size_t i, const base_engine &e){
+	word w[family::words];
+	e.get_state(w);
+	set_state(i, w);
+}
+
+/*
+ * a state and a newline per engine
+ */
+template <class Engine>
+size_t basic_engine_array<Engine>::dump_size() const{
+	return n_ * (xoshiro_io::state_chars<Engine>() + 1);
+}
+
+/*
+ * the text xoshiro_io::to_hex gives for each engine, so a line can be read
+ * back into a single engine as well. returns the bytes written.
+ */
+template <class Engine>
+size_t basic_engine_array<Engine>::dump_states(char *out, size_t size) const{
+	if(size < dump_size())
+		return 0;
+	char *p = out, *end = out + size;
+	for(size_t i = 0; i < n_; i++){
+		p = xoshiro_io::to_hex(p, end, get(i));
+		*p++ = '\n';
+	}
+	return p - out;
+}
+
+/*
+ * stops at the first line that isn't a valid state, at the end of the input or
+ * after size() engines, and returns the number of engines set. a line may end
+ * in "\r\n", and the last one needs no newline. engines past the count keep
+ * their states.
+ */
+template <class Engine>
+size_t basic_engine_array<Engine>::parse_states(const char *in, size_t size){
+	const char *p = in, *end = in + size;
+	word w[family::words] = { 1 }; // any valid state, from_hex replaces it
+	base_engine e(w);
+	size_t i = 0;
+	for(; i < n_; i++){
+		const char *q = xoshiro_io::from_hex(p, end, e);
+		if(!q)
+			break;
+		if(q < end && *q == '\r')
+			q++;
+		if(q < end && *q++ != '\n')
+			break;
+		set(i, e);
+		p = q;
+	}
+	return i;
+}
+
+/*
+ * the definitions above are templates, so any engine works in either mode;
+ * engine_array itself is instantiated once in src/xoshiro256.cpp with the
+ * compiled library, see xoshiro256_core.hpp
+ */
+#if !XOSHIRO256_IMPL
+extern template class basic_engine_array<xoshiro256ss>;
+#endif
+
+#endif /* XOSHIRO256_ARRAY_HPP_ */
@@ -0,0 +1,271 @@
+/*
+ * xoshiro256_constexpr.hpp
+ *
+ *  splitmix64 and every engine of the library as literal types, so tables that
+ *  only depend on a seed (hash salts, shuffled lookup tables, test fixtures, the
+ *  random parts of alias or ziggurat tables) can be computed by the compiler
+ *  with the same algorithms the program uses at run time, instead of at
+ *  startup or in a static initializer:
+ *
+ *      constexpr auto perm = xoshiro::ct::shuffled<256, uint8_t>(xoshiro::ct::xoshiro256ss(42));
+ *      constexpr uint64_t salt = xoshiro::ct::splitmix64(7)();
+ *
+ *  The runtime engines can't do this themselves: operator() is virtual, which
+ *  constexpr only allows from C++20, and with XOSHIRO256_LIBRARY their functions
+ *  live in the library. So ct::engine<Family, Scrambler> is a thin class
+ *  without virtual functions over the same family: the step, the scramblers,
+ *  the jump polynomials and xoshiro_detail::apply_poly are constexpr and called
+ *  by both, as are the splitmix64 finalizer and the uniform conversions. An
+ *  engine here and the runtime engine of the same name, started from the same
+ *  state, give the same sequence and the same states after jump() and
+ *  long_jump(), and ct::xoshiro256ss(seed) starts where seed_engine(e, seed)
+ *  does. xoshiro_selfcheck checks all of it, at compile time and at run time.
+ *
+ *  The loops need C++14 constexpr, so with C++11 the header is empty. There is
+ *  no advance(n) by polynomial; discard(n) walks. Compilers cap the work of a
+ *  constant expression (GCC at 2^18 iterations per loop, clang at 2^20
+ *  evaluation steps in total), which leaves room for tens of thousands of draws
+ *  per table; raise -fconstexpr-loop-limit or -fconstexpr-steps for more.
+ *
+ *  The functions are ordinary inline functions when called at run time.
+ */
+#ifndef XOSHIRO256_CONSTEXPR_HPP_
+#define XOSHIRO256_CONSTEXPR_HPP_
+
+#include "xoroshiro1024.hpp"
+#include "xoshiro128.hpp"
+#include "xoshiro512.hpp"
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304L
+
+namespace xoshiro_detail {
+
+/*
+ * the full product of two words as high and low halves, from 32-bit pieces so
+ * it needs no 128-bit type
+ */
+constexpr void mul_wide(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo) {
+	const uint64_t a0 = a & 0xffffffff, a1 = a >> 32;
+	const uint64_t b0 = b & 0xffffffff, b1 = b >> 32;
+	const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	const uint64_t mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+	lo = (mid << 32) | (p00 & 0xffffffff);
+	hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+constexpr void mul_wide(uint32_t a, uint32_t b, uint32_t &hi, uint32_t &lo) {
+	const uint64_t p = (uint64_t)a * b;
+	lo = (uint32_t)p;
+	hi = (uint32_t)(p >> 32);
+}
+
+} // namespace xoshiro_detail
+
+namespace xoshiro {
+namespace ct {
+
+/*
+ * class declaration for compile-time splitmix64
+ */
+class splitmix64 {
+public:
+	static constexpr uint64_t min() { return 0; } // returns 0
+	static constexpr uint64_t max() { return std::numeric_limits<uint64_t>::max(); } // returns the max uint64_t value
+	constexpr explicit splitmix64(uint64_t seed) : x(seed) {} // the constructor requires a seed
+	constexpr uint64_t operator()(); // gets the next value
+	uint64_t x; // the counter
+};
+
+/*
+ * class declaration for the compile-time engines. Family and Scrambler are
+ * those of the runtime engine, and the step, the jumps and the output are
+ * their functions, so the two can't drift apart.
+ */
+template <class Family, class Scrambler = typename Family::starstar>
+class engine {
+public:
+	typedef Family family; // the state transition
+	typedef Scrambler scrambler; // the output function
+	typedef typename Family::word word; // the type of a state word and of a value
+	static constexpr word min() { return 0; } // returns 0
+	static constexpr word max() { return std::numeric_limits<word>::max(); } // returns the max word value
+	template <unsigned W = Family::words, class = typename std::enable_if<W == 4>::type>
+	constexpr engine(word s0, word s1, word s2, word s3) : s{s0, s1, s2, s3}, p(0) {} // manual seeding, four-word families
+	constexpr explicit engine(const word (&state)[Family::words]); // the words in logical order, as the runtime constructor
+	constexpr explicit engine(uint64_t seed); // seeded like seed_engine(e, seed)
+	constexpr word operator()(); // gets the next value
+	constexpr void jump(); // the runtime engine's jump()
+	constexpr void long_jump(); // the runtime engine's long_jump()
+	constexpr void discard(uint64_t n); // n calls to (), one at a time
+	word s[Family::words]; // the state, laid out as in the runtime engine
+	unsigned p; // the ring start of xoroshiro1024, 0 for the other families
+};
+
+typedef engine<xoshiro_detail::xoshiro256_family> xoshiro256ss; // xoshiro256**
+typedef engine<xoshiro_detail::xoshiro256_family, xoshiro_detail::xoshiro256_family::plus> xoshiro256p; // xoshiro256+
+typedef engine<xoshiro_detail::xoshiro128_family> xoshiro128ss; // xoshiro128**
+typedef engine<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plus> xoshiro128p; // xoshiro128+
+typedef engine<xoshiro_detail::xoshiro128_family, xoshiro_detail::xoshiro128_family::plusplus> xoshiro128pp; // xoshiro128++
+typedef engine<xoshiro_detail::xoshiro512_family> xoshiro512ss; // xoshiro512**
+typedef engine<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plus> xoshiro512p; // xoshiro512+
+typedef engine<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plusplus> xoshiro512pp; // xoshiro512++
+typedef engine<xoshiro_detail::xoroshiro1024_family> xoroshiro1024ss; // xoroshiro1024**
+typedef engine<xoshiro_detail::xoroshiro1024_family, xoshiro_detail::xoroshiro1024_family::star> xoroshiro1024s; // xoroshiro1024*
+
+/*
+ * the value type of an engine
+ */
+template <class Engine>
+using result_t = decltype(std::declval<Engine&>()());
+
+/*
+ * what uniform() returns for an engine: double for the 64-bit ones, float for
+ * the 32-bit ones
+ */
+template <class Engine>
+using real_t = typename xoshiro_detail::uniform_conversion<result_t<Engine> >::real;
+
+/*
+ * a fixed-size array that constexpr functions can fill and return;
+ * std::array's non-const operator[] is only constexpr from C++17
+ */
+template <class T, size_t N>
+struct table {
+	T v[N]; // the values
+	constexpr T& operator[](size_t i) { return v[i]; }
+	constexpr const T& operator[](size_t i) const { return v[i]; }
+	static constexpr size_t size() { return N; }
+	constexpr const T* begin() const { return v; }
+	constexpr const T* end() const { return v + N; }
+};
+
+/*
+ * get the next number from splitmix
+ */
+constexpr uint64_t splitmix64::operator()() {
+	return xoshiro_detail::splitmix_mix(x += 0x9e3779b97f4a7c15);
+}
+
+/*
+ * the words in logical order, as the runtime state constructor
+ */
+template <class Family, class Scrambler>
+constexpr engine<Family, Scrambler>::engine(const word (&state)[Family::words]) : s{}, p(0) {
+	for(unsigned i = 0; i < Family::words; i++)
+		s[i] = state[i];
+}
+
+/*
+ * one splitmix64 output per state word, cut to the word size, with the same
+ * xoshiro_detail::seed_words() as seed_engine
+ */
+template <class Family, class Scrambler>
+constexpr engine<Family, Scrambler>::engine(uint64_t seed) : s{}, p(0) {
+	xoshiro_detail::seed_words(seed, s, Family::words);
+}
+
+/*
+ * the output of the scrambler, then one step
+ */
+template <class Family, class Scrambler>
+constexpr typename Family::word engine<Family, Scrambler>::operator()() {
+	const word result = Scrambler::scramble(s, p);
+	p = Family::step(s, p);
+	return result;
+}
+
+/*
+ * the family's jump polynomial through xoshiro_detail::apply_poly, as the
+ * runtime jump()
+ */
+template <class Family, class Scrambler>
+constexpr void engine<Family, Scrambler>::jump() {
+	p = xoshiro_detail::apply_poly<Family>(s, p, Family::jump_poly(), 0);
+}
+
+template <class Family, class Scrambler>
+constexpr void engine<Family, Scrambler>::long_jump() {
+	p = xoshiro_detail::apply_poly<Family>(s, p, Family::long_jump_poly(), 0);
+}
+
+template <class Family, class Scrambler>
+constexpr void engine<Family, Scrambler>::discard(uint64_t n) {
+	for(uint64_t i = 0; i < n; i++)
+		p = Family::step(s, p);
+}
+
+/*
+ * uniform reals in (low, high) with the conversion of the engine's value type,
+ * the one its runtime uniform() uses. the bounds have to be of the type it
+ * returns, so that a 32-bit engine can't be stretched over a double or a
+ * 64-bit one cut down to a float by the type of a literal.
+ */
+template <class Engine, class Real>
+constexpr Real uniform(Engine &e, Real low, Real high) {
+	typedef xoshiro_detail::uniform_conversion<result_t<Engine> > conversion;
+	static_assert(std::is_same<Real, typename conversion::real>::value,
+			"ct::uniform: the bounds must be real_t<Engine>, double for 64-bit engines and float for 32-bit ones");
+	result_t<Engine> n = e();
+	while(conversion::rejected(n))
+		n = e();
+	return conversion::convert(n, low, high);
+}
+
+/*
+ * uniform in [0, range), range > 0, by Lemire's multiply and reject: the high
+ * word of value*range is in [0, range), and rejecting the few low words below
+ * 2^w mod range makes every result equally likely. the modulo is only computed
+ * when a low word is small enough that it could be needed.
+ */
+template <class Engine>
+constexpr result_t<Engine> bounded(Engine &e, result_t<Engine> range) {
+	typedef result_t<Engine> word;
+	word hi = 0, lo = 0;
+	xoshiro_detail::mul_wide(e(), range, hi, lo);
+	if(lo < range){
+		const word floor = (word)(0 - range) % range;
+		while(lo < floor)
+			xoshiro_detail::mul_wide(e(), range, hi, lo);
+	}
+	return hi;
+}
+
+/*
+ * the first N values of e
+ */
+template <size_t N, class Engine>
+constexpr table<result_t<Engine>, N> draws(Engine e) {
+	table<result_t<Engine>, N> t{};
+	for(size_t i = 0; i < N; i++)
+		t[i] = e();
+	return t;
+}
+
+/*
+ * a random permutation of 0..N-1 as T, which has to hold N-1: Fisher-Yates
+ * from the top, drawing with bounded()
+ */
+template <size_t N, class T, class Engine>
+constexpr table<T, N> shuffled(Engine e) {
+	table<T, N> t{};
+	for(size_t i = 0; i < N; i++)
+		t[i] = (T)i;
+	for(size_t i = N; i > 1; i--){
+		const size_t j = (size_t)bounded(e, (result_t<Engine>)i);
+		const T x = t[i-1];
+		t[i-1] = t[j];
+		t[j] = x;
+	}
+	return t;
+}
+
+} // namespace ct
+} // namespace xoshiro
+
+#endif /* __cpp_constexpr */
+
+#endif /* XOSHIRO256_CONSTEXPR_HPP_ */
@@ -0,0 +1,1233 @@
+/*
+ * xoshiro256_core.hpp
+ *
+ *  Created on: Feb 16, 2021
+ *      Author: michael
+ *
+ *  This is based off of the C code provided on Sebastiano Vigna's website:
+ *  http://prng.di.unimi.it/splitmix64.c
+ *  http://prng.di.unimi.it/xoshiro256starstar.c
+ *  http://prng.di.unimi.it/xoshiro256plus.c
+ *
+ *  This header file combines these scripts and makes them into classes.
+ *  Additionally, there have been minor modifications to make this compatible
+ *  with the probability distribution functions in <random>. However, I have found
+ *  that these functions can be a bit slow, so I am adding some homemade functions
+ *  for converting random variables of other distributions more efficiently. Xoshiro256**
+ *  is used as the base class, as it is more precise, but Xoshiro256+ is explicitly
+ *  generating floating point numbers, so it is also included via inheritance.
+ *
+ *  This is the engine part only, kept to light standard headers since it ends
+ *  up in a lot of translation units. exponential() and geometric() are defined in
+ *  xoshiro256_distributions.hpp (they need <cmath>) and UI64T2String in
+ *  xoshiro256_io.hpp; xoshiro256.hpp includes all three.
+ *
+ *  ----------------------Original SplitMix Comments----------------------
+ *
+ *  To the extent possible under law, the author has dedicated all copyright
+ *  and related and neighboring rights to this software to the public domain
+ *  worldwide. This software is distributed without any warranty.
+ *
+ *  See <http://creativecommons.org/publicdomain/zero/1.0/>.
+ *
+ *  This is a fixed-increment version of Java 8's SplittableRandom generator
+ *  See http://dx.doi.org/10.1145/2714064.2660195 and
+ *  http://docs.oracle.com/javase/8/docs/api/java/util/SplittableRandom.html
+ *
+ *  It is a very fast generator passing BigCrush, and it can be useful if
+ *  for some reason you absolutely want 64 bits of state.
+ *
+ *  ---------------------Original Xoshiro256** Comments---------------------
+ *
+ *  Written in 2018 by David Blackman and Sebastiano Vigna (vigna@acm.org)
+ *
+ *  To the extent possible under law, the author has dedicated all copyright
+ *  and related and neighboring rights to this software to the public domain
+ *  worldwide. This software is distributed without any warranty.
+ *
+ *  See <http://creativecommons.org/publicdomain/zero/1.0/>
+ *
+ *  This is xoshiro256** 1.0, one of our all-purpose, rock-solid
+ *  generators. It has excellent (sub-ns) speed, a state (256 bits) that is
+ *  large enough for any parallel application, and it passes all tests we
+ *  are aware of.
+ *
+ *  For generating just floating-point numbers, xoshiro256+ is even faster.
+ *
+ *  The state must be seeded so that it is not everywhere zero. If you have
+ *  a 64-bit seed, we suggest to seed a splitmix64 generator and use its
+ *  output to fill s.
+ *
+ *  ---------------------Original Xoshiro256+ Comments---------------------
+ *
+ *  Written in 2018 by David Blackman and Sebastiano Vigna (vigna@acm.org)
+ *
+ *	To the extent possible under law, the author has dedicated all copyright
+ *	and related and neighboring rights to this software to the public domain
+ *	worldwide. This software is distributed without any warranty.
+ *
+ *	See <http://creativecommons.org/publicdomain/zero/1.0/>.
+ *
+ *  This is xoshiro256+ 1.0, our best and fastest generator for floating-point
+ *  numbers. We suggest to use its upper bits for floating-point
+ *  generation, as it is slightly faster than xoshiro256++/xoshiro256**. It
+ *  passes all tests we are aware of except for the lowest three bits,
+ *  which might fail linearity tests (and just those), so if low linear
+ *  complexity is not considered an issue (as it is usually the case) it
+ *  can be used to generate 64-bit outputs, too.
+ *
+ *  We suggest to use a sign test to extract a random Boolean value, and
+ *  right shifts to extract subsets of bits.
+ *
+ *  The state must be seeded so that it is not everywhere zero. If you have
+ *  a 64-bit seed, we suggest to seed a splitmix64 generator and use its
+ *  output to fill s.
+ */
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <limits>
+#include <type_traits>
+#ifndef XOSHIRO256_CORE_HPP_
+#define XOSHIRO256_CORE_HPP_
+
+/*
+ * By default the headers are header-only: every non-template function is
+ * defined inline, so they can be included from any number of translation units.
+ * Defining XOSHIRO256_LIBRARY everywhere switches to the compiled library
+ * instead: the headers then only declare those functions, and src/xoshiro256.cpp
+ * (the xoshiro256::compiled CMake target) defines them once, with
+ * XOSHIRO256_SOURCE set.
+ */
+#if defined(XOSHIRO256_LIBRARY)
+#define XOSHIRO256_DECL
+#else
+#define XOSHIRO256_DECL inline
+#endif
+#if !defined(XOSHIRO256_LIBRARY) || defined(XOSHIRO256_SOURCE)
+#define XOSHIRO256_IMPL 1
+#else
+#define XOSHIRO256_IMPL 0
+#endif
+
+/*
+ * the state transitions are constexpr where the language allows loops and
+ * assignments in constant expressions (C++14), for the compile-time engines in
+ * xoshiro256_constexpr.hpp, and ordinary inline functions before that
+ */
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304L
+#define XOSHIRO_CONSTEXPR14 constexpr
+#else
+#define XOSHIRO_CONSTEXPR14 inline
+#endif
+#ifdef XOSHIRO_INSTRUMENT
+#include <atomic>
+#endif
+
+class replay_log;
+
+namespace xoshiro_detail {
+template <unsigned W> class gf2_field;
+class engine_hooks;
+
+XOSHIRO256_DECL uint64_t time_seed(); // seed for the default constructors
+
+#ifdef XOSHIRO_INSTRUMENT
+/*
+ * what an engine has been asked for, see xoshiro256_instrument.hpp. an engine is
+ * only stepped by one thread at a time, so the counters are bumped with a plain
+ * load and store rather than a locked add; they are atomics only so the
+ * registry can read them from another thread.
+ */
+struct draw_counters {
+	std::atomic<uint64_t> draws{0}; // calls to () and previous()
+	std::atomic<uint64_t> uniform_retries{0}; // values uniform() rejected
+	std::atomic<uint64_t> jumps{0}; // calls to jump, long_jump, advance and retreat
+	std::atomic<uint64_t> uniform{0}; // calls to uniform, including those from exponential and geometric
+	std::atomic<uint64_t> exponential{0}; // calls to exponential
+	std::atomic<uint64_t> geometric{0}; // calls to geometric
+};
+
+/*
+ * single-writer increment
+ */
+inline void bump(std::atomic<uint64_t> &c){
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+class instrument_registry;
+void attach(engine_hooks *e); // adds a new engine to the registry if it has a label
+void detach(engine_hooks *e); // folds a dying engine's counts into its label's totals
+#endif
+
+#ifdef XOSHIRO_REPLAY
+/*
+ * where an engine is in its stream and where its checkpoints go, see
+ * xoshiro256_replay.hpp. a copy starts at the same position but isn't
+ * recorded, since two engines writing to one log would mix two streams.
+ */
+struct replay_cursor {
+	uint64_t position = 0; // draws since seeding
+	uint64_t next = UINT64_MAX; // position that triggers the next checkpoint
+	replay_log *log = nullptr; // not owned, null when not recording
+	replay_cursor() = default;
+	replay_cursor(const replay_cursor &o) : position(o.position) {}
+	replay_cursor& operator=(const replay_cursor &o){ position = o.position; return *this; }
+};
+
+template <class Engine>
+void checkpoint(Engine *e); // hands e's position and state to its log
+#endif
+}
+
+#ifdef XOSHIRO_INSTRUMENT
+#define XOSHIRO_COUNT(what) xoshiro_detail::bump(this->counters_.what)
+#else
+#define XOSHIRO_COUNT(what) ((void)0)
+#endif
+
+/*
+ * position bookkeeping for XOSHIRO_REPLAY: moving forward checks for a due
+ * checkpoint, moving back doesn't (the positions behind are covered already),
+ * and a jump to another stream is checkpointed right away
+ */
+#ifdef XOSHIRO_REPLAY
+#define XOSHIRO_MOVED(n) ((this->replay_.position += (n)) >= this->replay_.next ? xoshiro_detail::checkpoint(this) : (void)0)
+#define XOSHIRO_MOVED_BACK(n) ((void)(this->replay_.position -= (n)))
+#define XOSHIRO_RESTREAMED() (this->replay_.log ? xoshiro_detail::checkpoint(this) : (void)0)
+#else
+#define XOSHIRO_MOVED(n) ((void)0)
+#define XOSHIRO_MOVED_BACK(n) ((void)0)
+#define XOSHIRO_RESTREAMED() ((void)0)
+#endif
+
+/*
+ * class declaration for 64-bit splitmix
+ */
+class splitmix64 {
+public:
+	uint64_t min() const; // returns 0
+	uint64_t max() const; // returns the max uint64_t value
+	splitmix64(uint64_t x0); // the constructor requires a seed
+	uint64_t operator()(); // gets the next value. compatible with random's distributions
+	static uint64_t mix(uint64_t z); // the output function, a bijection of uint64_t
+	uint64_t at(uint64_t i) const; // the value the (i+1)th call to () would return, without advancing
+	void discard(uint64_t n); // skips n values in O(1)
+	void fill(uint64_t *out, size_t n); // same as n calls to (), but with no dependency between values
+private:
+	uint64_t x; // internal state
+};
+
+/*
+ * Rotation function using bit shifts. used in xoshiro256**
+ */
+constexpr uint64_t rotl(const uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+namespace xoshiro_detail {
+
+/*
+ * the splitmix finalizer, for splitmix64::mix() and the compile-time splitmix64.
+ * it is invertible, so distinct inputs give distinct outputs.
+ */
+XOSHIRO_CONSTEXPR14 uint64_t splitmix_mix(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+/*
+ * a state from a 64-bit seed: one splitmix64 output per word, cut to the word
+ * size. the default constructors, seed_engine() and the compile-time engines
+ * all seed this way.
+ */
+template <class Word>
+XOSHIRO_CONSTEXPR14 void seed_words(uint64_t seed, Word *s, unsigned words) {
+	for(unsigned i = 0; i < words; i++)
+		s[i] = (Word)splitmix_mix(seed += 0x9e3779b97f4a7c15);
+}
+
+/*
+ * the jump polynomials, in the layout of gf2_field below: bit b of word i is
+ * the coefficient of x^(64*i+b), so the 32-bit reference constants of xoshiro128
+ * come in pairs. static members of a class template like io_tables in
+ * xoshiro256_io.hpp, so every translation unit and the module share one
+ * definition; constexpr so they can be read in constant expressions.
+ */
+template <class T = void>
+struct jump_tables {
+	static constexpr uint64_t xoshiro256[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c }; // 2^128 steps
+	static constexpr uint64_t xoshiro256_long[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 }; // 2^192 steps
+	static constexpr uint64_t xoshiro128[2] = { 0xf542d2d38764000b, 0x77f2db5b6fa035c3 }; // 2^64 steps
+	static constexpr uint64_t xoshiro128_long[2] = { 0x0b6f099fb523952e, 0x1c580662ccf5a0ef }; // 2^96 steps
+	static constexpr uint64_t xoshiro512[8] = { 0x33ed89b6e7a353f9, 0x760083d7955323be, 0x2837f2fbb5f22fae, 0x4b8c5674d309511c,
+			0xb11ac47a7ba28c25, 0xf1be7667092bcc1c, 0x53851efdb6df0aaf, 0x1ebbc8b23eaf25db }; // 2^256 steps
+	static constexpr uint64_t xoshiro512_long[8] = { 0x11467fef8f921d28, 0xa2a819f2e79c8ea8, 0xa8299fc284b3959a, 0xb4d347340ca63ee1,
+			0x1cb0940bedbff6ce, 0xd956c5c4fa1f8e17, 0x915e38fd4eda93bc, 0x5b3ccdfa5d7daca5 }; // 2^384 steps
+	static constexpr uint64_t xoroshiro1024[16] = { 0x931197d8e3177f17, 0xb59422e0b9138c5f, 0xf06a6afb49d668bb, 0xacb8a6412c8a1401,
+			0x12304ec85f0b3468, 0xb7dfe7079209891e, 0x405b7eec77d9eb14, 0x34ead68280c44e4a,
+			0xe0e4ba3e0ac9e366, 0x8f46eda8348905b7, 0x328bf4dbad90d6ff, 0xc8fd6fb31c9effc3,
+			0xe899d452d4b67652, 0x45f387286ade3205, 0x03864f454a8920bd, 0xa68fa28725b1b384 }; // 2^512 steps
+	static constexpr uint64_t xoroshiro1024_long[16] = { 0x7374156360bbf00f, 0x4630c2efa3b3c1f6, 0x6654183a892786b1, 0x94f7bfcbfb0f1661,
+			0x27d8243d3d13eb2d, 0x9701730f3dfb300f, 0x2f293baae6f604ad, 0xa661831cb60cd8b6,
+			0x68280c77d9fe008c, 0x50554160f5ba9459, 0x2fc20b17ec7b2a9a, 0x49189bbdc8ec9f8f,
+			0x92a65bca41852cc1, 0xf46820dd0509c12a, 0x52b00c35fbf92185, 0x1e5b3b7f589e03c1 }; // 2^768 steps
+};
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoshiro256[4];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoshiro256_long[4];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoshiro128[2];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoshiro128_long[2];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoshiro512[8];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoshiro512_long[8];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoroshiro1024[16];
+
+template <class T>
+constexpr uint64_t jump_tables<T>::xoroshiro1024_long[16];
+
+/*
+ * the xoshiro256 state transition and its output functions. a family is
+ * everything the engine template below, engine_array, interleaved<N> and the
+ * compile-time engines need to know about a generator: the words, the step and
+ * its inverse, the jump polynomials, and a struct per output function. s is
+ * anything that indexes the words: an engine's state array, or one stream of
+ * the rows in interleaved<N>. p is the position of a ring state (see
+ * xoroshiro1024_family); the xoshiro state has none, so it is passed through
+ * and stays 0.
+ */
+struct xoshiro256_family {
+	typedef uint64_t word; // the type of a state word and of a value
+	enum : unsigned { words = 4 }; // state words
+	enum : bool { ring = false }; // whether the words are a ring that p moves around
+	enum : uint64_t { advance_steps = 1024, retreat_steps = 4096 }; // distances advance() and retreat() walk instead of using the field
+	static constexpr const uint64_t* jump_poly() { return jump_tables<>::xoshiro256; } // 2^128 steps
+	static constexpr const uint64_t* long_jump_poly() { return jump_tables<>::xoshiro256_long; } // 2^192 steps
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned step(S s, unsigned p); // one step of the state, returns the new p
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned unstep(S s, unsigned p); // the inverse of step()
+
+	struct starstar { // xoshiro256**
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned) { return rotl(s[1] * 5, 7) * 9; }
+	};
+	struct plus { // xoshiro256+
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned) { return s[0] + s[3]; }
+	};
+};
+
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoshiro256_family::step(S s, unsigned p) {
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+
+	s[3] = rotl(s[3], 45);
+	return p;
+}
+
+/*
+ * step() undone from the last line up. s[3] is rotated back and gives s[0].
+ * the new s[1] and s[2] are both the old ones xored with things known by now,
+ * except for the t = s[1] << 17 in s[2]; their xor is z = s[1] ^ (s[1] << 17),
+ * which the xor of shifts by 17, 34 and 51 inverts. that is done in two
+ * doublings to keep the dependency chain short.
+ */
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoshiro256_family::unstep(S s, unsigned p) {
+	const uint64_t s3s1 = rotl(s[3], 64 - 45);
+	uint64_t z = s[1] ^ s[2];
+	s[0] ^= s3s1;
+	const uint64_t s1s2 = s[1] ^ s[0];
+
+	z ^= z << 17;
+	s[1] = z ^ (z << 34);
+	s[2] = s1s2 ^ s[1];
+	s[3] = s3s1 ^ s[1];
+	return p;
+}
+
+/*
+ * the conversion of a value to a uniform real in (low, high), picked by the
+ * value type: rejected() tells which values to draw again for, convert() does
+ * the rest. the engines, interleaved<N> and the compile-time uniform() share it.
+ */
+template <class Word>
+struct uniform_conversion;
+
+/*
+ * 0 and the max value would give the ends of the interval exactly, so they are
+ * drawn again; a double then has enough bits for what's left
+ */
+template <>
+struct uniform_conversion<uint64_t> {
+	typedef double real; // what uniform() returns
+	enum : bool { rejects = true }; // whether rejected() is ever true
+	static constexpr bool rejected(uint64_t n) { return n==0||n==std::numeric_limits<uint64_t>::max(); }
+	static constexpr double convert(uint64_t n, double low, double high) {
+		return low + (high-low)*n/((double)std::numeric_limits<uint64_t>::max());
+	}
+};
+
+/*
+ * the state size of a family in the 64-bit words of gf2_field and the jump
+ * polynomials
+ */
+template <class Family>
+constexpr unsigned field_words() {
+	return Family::words * sizeof(typename Family::word) / 8;
+}
+
+/*
+ * the body of the original jump functions, for every family: accumulates the
+ * states at the set bits of poly while stepping through it, and returns the
+ * new p. the words are taken in logical order, from p on for a ring. poly only
+ * gives the words relative to p, so a ring is then placed where steps draws
+ * would have left it; the jumps are whole turns of the ring and pass 0. the
+ * walk is on a local copy, which the compiler keeps apart from poly.
+ */
+template <class Family, class S>
+XOSHIRO_CONSTEXPR14 unsigned apply_poly(S s, unsigned p, const uint64_t *poly, uint64_t steps) {
+	const unsigned mask = Family::words - 1;
+	typename Family::word x[Family::words] = {}, t[Family::words] = {};
+	for(unsigned j = 0; j < Family::words; j++)
+		x[j] = s[j];
+	for(unsigned i = 0; i < field_words<Family>(); i++)
+		for(unsigned b = 0; b < 64; b++) {
+			if (poly[i] & UINT64_C(1) << b)
+				for(unsigned j = 0; j < Family::words; j++)
+					t[j] ^= x[(j + p) & mask];
+			p = Family::step(x, p);
+		}
+
+	if(Family::ring)
+		p = (p + steps) & mask;
+	for(unsigned j = 0; j < Family::words; j++)
+		s[(j + p) & mask] = t[j];
+	return p;
+}
+
+/*
+ * one step of an engine's own state array. that is the family's step, unless
+ * the family has a faster way for a contiguous array (xoshiro128.hpp does).
+ */
+template <class Family>
+inline unsigned step_state(typename Family::word *s, unsigned p) {
+	return Family::step(s, p);
+}
+
+/*
+ * the start of a ring state. the families without one have nothing to store
+ * and read it as 0.
+ */
+template <bool Ring>
+struct ring_base {
+	unsigned pos() const { return 0; } // the ring start
+	void pos(unsigned) {} // sets the ring start
+};
+
+template <>
+struct ring_base<true> {
+	int p; // index of the word written last; s[(p+1)&(words-1)] is read next
+	unsigned pos() const { return p; } // the ring start
+	void pos(unsigned q) { p = q; } // sets the ring start
+};
+
+/*
+ * what XOSHIRO_INSTRUMENT and XOSHIRO_REPLAY add to every engine: the counters
+ * and label, and the replay cursor. a base of its own so the registry and the
+ * log deal with one type whatever the engine; empty without the macros.
+ */
+class engine_hooks {
+#ifdef XOSHIRO_INSTRUMENT
+public:
+	engine_hooks(); // unlabeled, so the registry only hears of it when it is labeled or destroyed
+	engine_hooks(const engine_hooks &o); // copies the label, the counts start at zero. a labeled copy is registered
+	engine_hooks& operator=(const engine_hooks &o); // the counts and the label stay
+	~engine_hooks(); // hands the counts to the registry
+#endif
+protected:
+#ifdef XOSHIRO_INSTRUMENT
+	friend class instrument_registry;
+	draw_counters counters_; // this engine's counts
+	const char *label_ = nullptr; // what the counts are aggregated under
+#endif
+#ifdef XOSHIRO_REPLAY
+	friend class ::replay_log;
+	template <class Engine>
+	friend void checkpoint(Engine *e);
+	replay_cursor replay_; // position and log
+#endif
+};
+
+} // namespace xoshiro_detail
+
+/*
+ * class declaration for the engines. Family picks the generator, and this is
+ * its ** version; xoshiro_scrambled below swaps the output function. Every
+ * member works the same for every family, so switching generators is a change
+ * of type: xoshiro256ss, xoshiro128ss, xoshiro512ss and xoroshiro1024ss are all
+ * this class.
+ */
+template <class Family>
+class xoshiro_engine : public xoshiro_detail::engine_hooks, public xoshiro_detail::ring_base<Family::ring> {
+public:
+	typedef Family family; // the state transition
+	typedef typename Family::starstar scrambler; // the output function
+	typedef typename Family::word word; // the type of a state word and of a value
+	typedef typename xoshiro_detail::uniform_conversion<word>::real real; // what uniform() returns
+	word min() const; // returns 0
+	word max() const; // returns the max word value
+	xoshiro_engine(); // default constructor with seeding from time and splitmix
+	explicit xoshiro_engine(const word (&state)[Family::words]); // constructor with manual seeding from all the words, p = 0
+	template <unsigned W = Family::words, class = typename std::enable_if<W == 4>::type>
+	xoshiro_engine(word s0, word s1, word s2, word s3) { // constructor with manual seeding, four-word families
+		const word state[] = { s0, s1, s2, s3 };
+		set_state(state);
+	}
+	virtual ~xoshiro_engine(){}; // destructor
+	virtual word operator ()(); // gets the next value. compatible with random's distributions
+	virtual word previous(); // steps back one value and returns it: undoes the last ()
+	real uniform(real low, real high); // generates uniform reals in (a,b), see xoshiro_detail::uniform_conversion
+	real exponential(real mean); // generates an exponential RV given the mean. in xoshiro256_distributions.hpp
+	int geometric(real success); // generates a geometric RV... P(i failures) = p(1-p)^i. in xoshiro256_distributions.hpp
+	void jump(); // this performs a jump: 2^(bits/2) values for a state of that many bits
+	void jump(uint64_t n); // the same as n jumps, in constant time
+	void long_jump(); // this performs a larger jump: 2^(3*bits/4) values
+	void long_jump(uint64_t n); // the same as n long jumps, in constant time
+	void advance(uint64_t n); // moves the state forward as if n values had been drawn
+	void retreat(uint64_t n); // moves the state back as if the last n values had not been drawn
+	xoshiro_engine split(); // returns an independent child engine, advancing this one by one draw per word
+	void get_state(word *out) const; // the words in logical order, from s[p] on for a ring
+	void set_state(const word *state); // replaces the words, p = 0
+#ifdef XOSHIRO_REPLAY
+	uint64_t position() const; // draws since seeding: () adds one, previous() takes one off, advance and retreat n
+	void record(replay_log *log); // checkpoints into log from now on, null stops
+#endif
+	typedef xoshiro_detail::gf2_field<xoshiro_detail::field_words<Family>()> field_type; // polynomials modulo the characteristic one
+	static const field_type& field(); // the field the jump powers are computed in, built on the first call
+	word s[Family::words]; // the state
+protected:
+	void split_state(word *child); // fills the words of a child state
+	void step(); // the state transition alone, shared by all the scramblers
+	void unstep(); // the inverse of step()
+	void apply_poly(const uint64_t *poly, uint64_t steps = 0); // replaces the state with poly(T)*s, T being one step; poly stands for steps draws
+	void apply_power(const uint64_t *poly, uint64_t n); // applies poly^n
+};
+
+/*
+ * class declaration for the other outputs of a family (xoshiro256+ and so
+ * on)... only the () operator is different
+ */
+template <class Family, class Scrambler>
+class xoshiro_scrambled : public xoshiro_engine<Family> {
+public:
+	using xoshiro_engine<Family>::xoshiro_engine; // same constructors as the ** engine
+	typedef Scrambler scrambler; // the output function
+	typedef typename Family::word word; // the type of a state word and of a value
+	word operator()() override; // gets the next value. compatible with random's distributions
+	word previous() override; // steps back one value and returns it: undoes the last ()
+	xoshiro_scrambled split(); // returns an independent child engine, advancing this one by one draw per word
+	~xoshiro_scrambled(){}; // destructor
+};
+
+typedef xoshiro_engine<xoshiro_detail::xoshiro256_family> xoshiro256ss; // xoshiro256**
+typedef xoshiro_scrambled<xoshiro_detail::xoshiro256_family, xoshiro_detail::xoshiro256_family::plus> xoshiro256p; // xoshiro256+
+namespace xoshiro_detail {
+
+/*
+ * Polynomials over GF(2) modulo the characteristic polynomial p(x) of a linear
+ * engine whose state is W uint64_t. A polynomial of degree < 64*W is stored as W
+ * words, bit b of word i being the coefficient of x^(64*i+b); this is the same
+ * layout as jump_tables. Since p(T) = 0 for the engine's
+ * transition T, x^n mod p(x) evaluated at T is the same as n steps.
+ */
+template <unsigned W>
+class gf2_field {
+public:
+	gf2_field(const unsigned char *bits); // builds p from 128*W bits of one state bit over consecutive steps
+	void mulx(uint64_t *a) const; // a = a*x mod p
+	void sqr(uint64_t *a) const; // a = a*a mod p
+	void mul(uint64_t *a, const uint64_t *b) const; // a = a*b mod p
+	void pow_x(uint64_t n, uint64_t *r) const; // r = x^n mod p
+	void pow(const uint64_t *b, uint64_t n, uint64_t *r) const; // r = b^n mod p
+	void inv_x(uint64_t *r) const; // r = 1/x mod p
+	uint64_t p[W]; // coefficients of p below x^(64*W), which is implicit
+private:
+	void reduce(uint64_t *v) const; // reduces the 2*W word product in v, result in v[0..W-1]
+	static uint64_t spread(uint64_t x); // moves bit i of a 32-bit value to bit 2i
+	static unsigned ctz(uint64_t x); // index of the lowest set bit, x != 0
+	uint64_t red[64*W][W]; // x^(64*W+k) mod p, used to fold the high half of products
+};
+
+/*
+ * Berlekamp-Massey over GF(2). The engines have full period, so p(x) is primitive
+ * and the minimal polynomial of any nonzero bit sequence they produce is p itself.
+ */
+template <unsigned W>
+gf2_field<W>::gf2_field(const unsigned char *bits){
+	const unsigned N = 128*W;
+	unsigned char C[64*W+1] = {1}, B[64*W+1] = {1}, T[64*W+1];
+	unsigned L = 0, m = 1;
+	for(unsigned n = 0; n < N; n++){
+		unsigned char d = bits[n];
+		for(unsigned i = 1; i <= L; i++)
+			d ^= C[i] & bits[n-i];
+		if(d == 0){
+			m++;
+			continue;
+		}
+		for(unsigned i = 0; i <= 64*W; i++)
+			T[i] = C[i];
+		for(unsigned i = 0; i + m <= 64*W; i++)
+			C[i+m] ^= B[i];
+		if(2*L <= n){
+			L = n+1-L;
+			for(unsigned i = 0; i <= 64*W; i++)
+				B[i] = T[i];
+			m = 1;
+		} else {
+			m++;
+		}
+	}
+	// p(x) = x^L C(1/x), L = 64*W
+	for(unsigned i = 0; i < W; i++)
+		p[i] = 0;
+	for(unsigned j = 0; j < 64*W; j++)
+		if(C[64*W-j])
+			p[j/64] |= UINT64_C(1) << (j%64);
+	uint64_t a[W] = {0};
+	for(unsigned i = 0; i < W; i++)
+		a[i] = p[i];
+	for(unsigned k = 0; k < 64*W; k++){
+		for(unsigned i = 0; i < W; i++)
+			red[k][i] = a[i];
+		mulx(a);
+	}
+}
+
+/*
+ * a = a*x mod p
+ */
+template <unsigned W>
+void gf2_field<W>::mulx(uint64_t *a) const{
+	const uint64_t carry = a[W-1] >> 63;
+	for(unsigned i = W-1; i > 0; i--)
+		a[i] = (a[i] << 1) | (a[i-1] >> 63);
+	a[0] <<= 1;
+	if(carry)
+		for(unsigned i = 0; i < W; i++)
+			a[i] ^= p[i];
+}
+
+/*
+ * folds the words above W back in using the precomputed x^(64*W+k) mod p
+ */
+template <unsigned W>
+void gf2_field<W>::reduce(uint64_t *v) const{
+	for(unsigned i = 0; i < W; i++)
+		for(uint64_t h = v[W+i]; h; h &= h-1){
+			const uint64_t *r = red[64*i + ctz(h)];
+			for(unsigned j = 0; j < W; j++)
+				v[j] ^= r[j];
+		}
+}
+
+/*
+ * the builtin where there is one, otherwise a binary search
+ */
+template <unsigned W>
+unsigned gf2_field<W>::ctz(uint64_t x){
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	unsigned n = 0;
+	for(unsigned k = 32; k; k >>= 1)
+		if(!(x & ((UINT64_C(1) << k) - 1))){
+			n += k;
+			x >>= k;
+		}
+	return n;
+#endif
+}
+
+/*
+ * interleaves zeros between the low 32 bits
+ */
+template <unsigned W>
+uint64_t gf2_field<W>::spread(uint64_t x){
+	x = (x | (x << 16)) & 0x0000ffff0000ffff;
+	x = (x | (x << 8)) & 0x00ff00ff00ff00ff;
+	x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+	x = (x | (x << 2)) & 0x3333333333333333;
+	x = (x | (x << 1)) & 0x5555555555555555;
+	return x;
+}
+
+/*
+ * squaring over GF(2) just spreads bit i to bit 2i
+ */
+template <unsigned W>
+void gf2_field<W>::sqr(uint64_t *a) const{
+	uint64_t v[2*W];
+	for(unsigned i = 0; i < W; i++){
+		v[2*i] = spread(a[i] & 0xffffffff);
+		v[2*i+1] = spread(a[i] >> 32);
+	}
+	reduce(v);
+	for(unsigned i = 0; i < W; i++)
+		a[i] = v[i];
+}
+
+/*
+ * carry-less multiplication, four bits of b at a time (comb method with a
+ * table of the 16 multiples of a), followed by reduction
+ */
+template <unsigned W>
+void gf2_field<W>::mul(uint64_t *a, const uint64_t *b) const{
+	uint64_t T[16][W+1];
+	for(unsigned k = 0; k <= W; k++)
+		T[0][k] = 0;
+	for(unsigned k = 0; k < W; k++)
+		T[1][k] = a[k];
+	T[1][W] = 0;
+	for(unsigned m = 2; m < 16; m++)
+		for(unsigned k = 0; k <= W; k++)
+			T[m][k] = (m & 1) ? T[m-1][k] ^ T[1][k]
+			                  : (T[m/2][k] << 1) | (k ? T[m/2][k-1] >> 63 : 0);
+	uint64_t v[2*W] = {0};
+	for(int j = 15; j >= 0; j--){
+		for(unsigned i = 0; i < W; i++){
+			const uint64_t *t = T[(b[i] >> (4*j)) & 15];
+			for(unsigned k = 0; k <= W && i+k < 2*W; k++)
+				v[i+k] ^= t[k];
+		}
+		if(j){
+			for(unsigned k = 2*W-1; k > 0; k--)
+				v[k] = (v[k] << 4) | (v[k-1] >> 60);
+			v[0] <<= 4;
+		}
+	}
+	reduce(v);
+	for(unsigned i = 0; i < W; i++)
+		a[i] = v[i];
+}
+
+/*
+ * left-to-right square and multiply. multiplying by x is a shift, so this is
+ * 64 squarings at most.
+ */
+template <unsigned W>
+void gf2_field<W>::pow_x(uint64_t n, uint64_t *r) const{
+	for(unsigned i = 0; i < W; i++)
+		r[i] = 0;
+	r[0] = 1;
+	for(int b = 63; b >= 0; b--){
+		sqr(r);
+		if((n >> b) & 1)
+			mulx(r);
+	}
+}
+
+/*
+ * same as pow_x for an arbitrary base
+ */
+template <unsigned W>
+void gf2_field<W>::pow(const uint64_t *b, uint64_t n, uint64_t *r) const{
+	for(unsigned i = 0; i < W; i++)
+		r[i] = 0;
+	r[0] = 1;
+	for(int k = 63; k >= 0; k--){
+		sqr(r);
+		if((n >> k) & 1)
+			mul(r, b);
+	}
+}
+
+/*
+ * the transition is invertible, so p(0) = 1 and x * (p(x) - 1)/x = 1 mod p.
+ * dividing by x is a shift down, and the implicit top coefficient of p lands
+ * in the top bit.
+ */
+template <unsigned W>
+void gf2_field<W>::inv_x(uint64_t *r) const{
+	for(unsigned i = 0; i < W; i++)
+		r[i] = (p[i] >> 1) | (i+1 < W ? p[i+1] << 63 : UINT64_C(1) << 63);
+}
+
+} // namespace xoshiro_detail
+
+#if XOSHIRO256_IMPL
+
+/*
+ * the wall clock in nanoseconds, for seeding a splitmix64. timespec_get gives
+ * the same count as the system clock without pulling in <chrono>, but <time.h>
+ * only declares it for C11 and C++17; before that TIME_UTC is missing (g++
+ * -std=c++11 without _GNU_SOURCE) and the seconds from time() are mixed with
+ * clock() and a stack address, which ASLR moves from run to run.
+ */
+XOSHIRO256_DECL uint64_t xoshiro_detail::time_seed(){
+#ifdef TIME_UTC
+	timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+	const uint64_t t = (uint64_t)time(0) * 1000000000 + (uint64_t)clock();
+	return t ^ ((uint64_t)(uintptr_t)&t << 16);
+#endif
+}
+
+/*
+ * splitmix64 constructor, requires a seed
+ */
+XOSHIRO256_DECL splitmix64::splitmix64(uint64_t x0){
+	x=x0;
+}
+
+/*
+ * get the next number from splitmix
+ */
+XOSHIRO256_DECL uint64_t splitmix64::operator ()() {
+	return mix(x += 0x9e3779b97f4a7c15);
+}
+
+/*
+ * splitmix is a Weyl sequence fed through mix(), so any output can be computed
+ * directly from the counter
+ */
+XOSHIRO256_DECL uint64_t splitmix64::at(uint64_t i) const {
+	return mix(x + (i+1) * 0x9e3779b97f4a7c15);
+}
+
+/*
+ * skip ahead n values
+ */
+XOSHIRO256_DECL void splitmix64::discard(uint64_t n) {
+	x += n * 0x9e3779b97f4a7c15;
+}
+
+/*
+ * bulk generation. every value only depends on its index, so the compiler can
+ * vectorize the loop (vpmullq with AVX-512DQ, emulated multiplies with AVX2).
+ */
+XOSHIRO256_DECL void splitmix64::fill(uint64_t *out, size_t n) {
+	const uint64_t base = x;
+	for(size_t i = 0; i < n; i++)
+		out[i] = mix(base + (i+1) * 0x9e3779b97f4a7c15);
+	x = base + n * 0x9e3779b97f4a7c15;
+}
+
+/*
+ * the splitmix finalizer, see xoshiro_detail::splitmix_mix()
+ */
+XOSHIRO256_DECL uint64_t splitmix64::mix(uint64_t z) {
+	return xoshiro_detail::splitmix_mix(z);
+}
+
+/*
+ * splitmix min val
+ */
+XOSHIRO256_DECL uint64_t splitmix64::min() const{
+	return 0;
+}
+
+/*
+ * xoshiro max val
+ */
+XOSHIRO256_DECL uint64_t splitmix64::max() const{
+	return std::numeric_limits<uint64_t>::max();
+}
+
+#ifdef XOSHIRO_INSTRUMENT
+/*
+ * every engine checks in on construction, which only tracks labeled ones
+ */
+XOSHIRO256_DECL xoshiro_detail::engine_hooks::engine_hooks(){
+	attach(this);
+}
+
+/*
+ * a copy draws for whoever the original was drawing for
+ */
+XOSHIRO256_DECL xoshiro_detail::engine_hooks::engine_hooks(const engine_hooks &o) : label_(o.label_) {
+#ifdef XOSHIRO_REPLAY
+	replay_ = o.replay_;
+#endif
+	attach(this);
+}
+
+/*
+ * the counts and the label stay with the engine being assigned to
+ */
+XOSHIRO256_DECL xoshiro_detail::engine_hooks& xoshiro_detail::engine_hooks::operator=(const engine_hooks &o){
+#ifdef XOSHIRO_REPLAY
+	replay_ = o.replay_;
+#else
+	(void)o;
+#endif
+	return *this;
+}
+
+/*
+ * instrumented destructor
+ */
+XOSHIRO256_DECL xoshiro_detail::engine_hooks::~engine_hooks(){
+	detach(this);
+}
+#endif
+
+/*
+ * xoshiro min val
+ */
+template <class Family>
+XOSHIRO256_DECL typename Family::word xoshiro_engine<Family>::min() const{
+	return 0;
+}
+
+/*
+ * xoshiro max val
+ */
+template <class Family>
+XOSHIRO256_DECL typename Family::word xoshiro_engine<Family>::max() const{
+	return std::numeric_limits<word>::max();
+}
+
+/*
+ * default xoshiro constructor, seeded from the time like seed_engine() seeds
+ * from a number, see xoshiro_detail::seed_words()
+ */
+template <class Family>
+XOSHIRO256_DECL xoshiro_engine<Family>::xoshiro_engine(){
+	xoshiro_detail::seed_words(xoshiro_detail::time_seed(), s, Family::words);
+	this->pos(0);
+}
+
+/*
+ * specific xoshiro constructor, need to provide all the words
+ */
+template <class Family>
+XOSHIRO256_DECL xoshiro_engine<Family>::xoshiro_engine(const word (&state)[Family::words]){
+	set_state(state);
+}
+
+/*
+ * get the next number from the ** output
+ */
+template <class Family>
+XOSHIRO256_DECL typename Family::word xoshiro_engine<Family>::operator()() {
+	XOSHIRO_COUNT(draws);
+	const word result = scrambler::scramble(s, this->pos());
+	step();
+	XOSHIRO_MOVED(1);
+	return result;
+}
+
+/*
+ * get the next number from the other outputs
+ */
+template <class Family, class Scrambler>
+XOSHIRO256_DECL typename Family::word xoshiro_scrambled<Family, Scrambler>::operator()() {
+	XOSHIRO_COUNT(draws);
+	const word result = scrambler::scramble(this->s, this->pos());
+	this->step();
+	XOSHIRO_MOVED(1);
+	return result;
+}
+
+/*
+ * step back and return the output of the earlier state, which is the value
+ * the () that moved past it returned
+ */
+template <class Family>
+XOSHIRO256_DECL typename Family::word xoshiro_engine<Family>::previous() {
+	XOSHIRO_COUNT(draws);
+	unstep();
+	XOSHIRO_MOVED_BACK(1);
+	return scrambler::scramble(s, this->pos());
+}
+
+/*
+ * same as xoshiro_engine::previous() with the other output
+ */
+template <class Family, class Scrambler>
+XOSHIRO256_DECL typename Family::word xoshiro_scrambled<Family, Scrambler>::previous() {
+	XOSHIRO_COUNT(draws);
+	this->unstep();
+	XOSHIRO_MOVED_BACK(1);
+	return scrambler::scramble(this->s, this->pos());
+}
+
+/*
+ * returns a uniform real in the open interval (low, high): a double from
+ * 64-bit values, a float from 32-bit ones
+ */
+template <class Family>
+XOSHIRO256_DECL typename xoshiro_engine<Family>::real xoshiro_engine<Family>::uniform(real low, real high){
+	// You could use epsilon to avoid n=0 or n=max, but it's faster to just check
+	// and try again, if need be.
+	XOSHIRO_COUNT(uniform);
+	typedef xoshiro_detail::uniform_conversion<word> conversion;
+	word n = (*this)();
+	while(conversion::rejected(n)){
+		XOSHIRO_COUNT(uniform_retries);
+		n = (*this)();
+	}
+	return conversion::convert(n, low, high);
+}
+
+/*
+ * splits off a child engine, in the spirit of SplittableRandom.split(). The
+ * child's state is parent outputs passed through the splitmix finalizer,
+ * so it lands at an unrelated point of the period rather than a nearby one.
+ * Everything is derived from the parent's state, so a fork-join tree of splits
+ * gives the same streams no matter which thread runs which task.
+ */
+template <class Family>
+XOSHIRO256_DECL xoshiro_engine<Family> xoshiro_engine<Family>::split() {
+	const word zero[Family::words] = {};
+	xoshiro_engine child(zero);
+	split_state(child.s);
+	return child;
+}
+
+/*
+ * same as xoshiro_engine::split(), but the child keeps the output
+ */
+template <class Family, class Scrambler>
+XOSHIRO256_DECL xoshiro_scrambled<Family, Scrambler> xoshiro_scrambled<Family, Scrambler>::split() {
+	const word zero[Family::words] = {};
+	xoshiro_scrambled child(zero);
+	this->split_state(child.s);
+	return child;
+}
+
+/*
+ * draws the child's state, which starts at p = 0 like a newly seeded one.
+ * mix() is a bijection, so the all-zero state would need specific parent
+ * outputs in a row; it is still checked for.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::split_state(word *child) {
+	word any;
+	do {
+		any = 0;
+		for(unsigned i = 0; i < Family::words; i++)
+			any |= child[i] = (word)splitmix64::mix((*this)() + 0x9e3779b97f4a7c15);
+	} while(any == 0);
+}
+
+/*
+ * the words as the field and the jump polynomials see them: a ring starts at
+ * the word written last
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::get_state(word *out) const{
+	for(unsigned j = 0; j < Family::words; j++)
+		out[j] = s[(j + this->pos()) & (Family::words - 1)];
+}
+
+/*
+ * the inverse of get_state()
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::set_state(const word *state){
+	for(unsigned j = 0; j < Family::words; j++)
+		s[j] = state[j];
+	this->pos(0);
+}
+
+/*
+ * jump function for xoshiro. the comment is the one for xoshiro256, the other
+ * distances are listed with jump_tables.
+ *
+ * ----------------------Original Comments----------------------
+ *
+ * This is the jump function for the generator. It is equivalent
+ * to 2^128 calls to next(); it can be used to generate 2^128
+ * non-overlapping subsequences for parallel computations.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::jump() {
+	XOSHIRO_COUNT(jumps);
+	apply_poly(Family::jump_poly());
+	XOSHIRO_RESTREAMED();
+}
+
+/*
+ * n jumps at once: raises the jump polynomial to the nth power, so this costs
+ * about as much as a few jumps whatever n is. handy for giving the nth task or
+ * process the nth stream without walking there.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::jump(uint64_t n) {
+	XOSHIRO_COUNT(jumps);
+	apply_power(Family::jump_poly(), n);
+	XOSHIRO_RESTREAMED();
+}
+
+/*
+ * long jump function for xoshiro
+ *
+ * ----------------------Original Comments----------------------
+ *
+ * This is the long-jump function for the generator. It is equivalent to
+ * 2^192 calls to next(); it can be used to generate 2^64 starting points,
+ * from each of which jump() will generate 2^64 non-overlapping
+ * subsequences for parallel distributed computations.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::long_jump() {
+	XOSHIRO_COUNT(jumps);
+	apply_poly(Family::long_jump_poly());
+	XOSHIRO_RESTREAMED();
+}
+
+/*
+ * n long jumps at once, see jump(uint64_t)
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::long_jump(uint64_t n) {
+	XOSHIRO_COUNT(jumps);
+	apply_power(Family::long_jump_poly(), n);
+	XOSHIRO_RESTREAMED();
+}
+
+/*
+ * jump ahead by an arbitrary number of steps. this computes x^n mod p(x), then
+ * applies it the same way jump() applies its constant, so the cost does not
+ * depend on n. short distances are cheaper to just step through; how short
+ * grows with the state, see the families.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::advance(uint64_t n) {
+	XOSHIRO_COUNT(jumps);
+	if(n <= Family::advance_steps){
+		for(uint64_t i = 0; i < n; i++)
+			step();
+	} else {
+		uint64_t poly[xoshiro_detail::field_words<Family>()];
+		field().pow_x(n, poly);
+		apply_poly(poly, n);
+	}
+	XOSHIRO_MOVED(n);
+}
+
+/*
+ * the same as advance() in the other direction: x^-n mod p(x) applied like a
+ * jump polynomial. x^-1 has no short form like x, so this pays for a general
+ * power and the stepping covers a longer range.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::retreat(uint64_t n) {
+	XOSHIRO_COUNT(jumps);
+	if(n <= Family::retreat_steps){
+		for(uint64_t i = 0; i < n; i++)
+			unstep();
+	} else {
+		uint64_t inv[xoshiro_detail::field_words<Family>()], poly[xoshiro_detail::field_words<Family>()];
+		field().inv_x(inv);
+		field().pow(inv, n, poly);
+		apply_poly(poly, 0 - n);
+	}
+	XOSHIRO_MOVED_BACK(n);
+}
+
+/*
+ * one step of the generator without computing an output. the transition is the
+ * same for all the outputs, so the jumps don't need the virtual () and don't
+ * count as draws.
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::step() {
+	this->pos(xoshiro_detail::step_state<Family>(s, this->pos()));
+}
+
+/*
+ * see the family's unstep()
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::unstep() {
+	this->pos(Family::unstep(s, this->pos()));
+}
+
+/*
+ * see xoshiro_detail::apply_poly()
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::apply_poly(const uint64_t *poly, uint64_t steps) {
+	this->pos(xoshiro_detail::apply_poly<Family>(s, this->pos(), poly, steps));
+}
+
+/*
+ * a few single jumps are cheaper than the power
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::apply_power(const uint64_t *poly, uint64_t n) {
+	if(n <= 4){
+		for(uint64_t i = 0; i < n; i++)
+			apply_poly(poly);
+		return;
+	}
+	uint64_t r[xoshiro_detail::field_words<Family>()];
+	field().pow(poly, n, r);
+	apply_poly(r);
+}
+
+/*
+ * the characteristic polynomial is recovered once from the low bit of the
+ * first word in logical order, s[p] for a ring
+ */
+template <class Family>
+XOSHIRO256_DECL const typename xoshiro_engine<Family>::field_type& xoshiro_engine<Family>::field() {
+	static const field_type f = []{
+		unsigned char bits[128*xoshiro_detail::field_words<Family>()];
+		word t[Family::words] = {1};
+		unsigned p = 0;
+		for(unsigned i = 0; i < sizeof(bits); i++){
+			bits[i] = t[p] & 1;
+			p = Family::step(t, p);
+		}
+		return field_type(bits);
+	}();
+	return f;
+}
+
+#endif /* XOSHIRO256_IMPL */
+
+/*
+ * with the compiled library the engines are instantiated once in
+ * src/xoshiro256.cpp, like the non-template functions are defined there
+ */
+#if !XOSHIRO256_IMPL
+extern template class xoshiro_engine<xoshiro_detail::xoshiro256_family>;
+extern template class xoshiro_scrambled<xoshiro_detail::xoshiro256_family, xoshiro_detail::xoshiro256_family::plus>;
+#endif
+
+#ifdef XOSHIRO_INSTRUMENT
+#include "xoshiro256_instrument.hpp"
+#endif
+#ifdef XOSHIRO_REPLAY
+#include "xoshiro256_replay.hpp"
+#endif
+
+#endif /* XOSHIRO256_CORE_HPP_ */
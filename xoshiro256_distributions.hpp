@@ -0,0 +1,41 @@
+/*
+ * xoshiro256_distributions.hpp
+ *
+ *  The homemade distribution functions of the engines that need <cmath>:
+ *  exponential() and geometric(). They are declared with the engine template
+ *  in xoshiro256_core.hpp; include this header (or xoshiro256.hpp) wherever
+ *  they are called. uniform() only needs <limits> and stays in the core header.
+ *  Both take their real type from uniform(), so the 32-bit engines work in
+ *  float.
+ */
+#ifndef XOSHIRO256_DISTRIBUTIONS_HPP_
+#define XOSHIRO256_DISTRIBUTIONS_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <cmath>
+
+#if XOSHIRO256_IMPL
+
+/*
+ * generates and exponential random variable with specified mean
+ */
+template <class Family>
+XOSHIRO256_DECL typename xoshiro_engine<Family>::real xoshiro_engine<Family>::exponential(real mean){
+	XOSHIRO_COUNT(exponential);
+	real r = uniform(0,1);
+	return -mean*std::log(1-r);
+}
+
+/*
+ * returns a geometric random variable (int)
+ */
+template <class Family>
+XOSHIRO256_DECL int xoshiro_engine<Family>::geometric(real success){
+	XOSHIRO_COUNT(geometric);
+	real r = uniform(0,1);
+	return std::ceil(-1+(std::log(1-r)/std::log(1-success)));
+}
+
+#endif /* XOSHIRO256_IMPL */
+
+#endif /* XOSHIRO256_DISTRIBUTIONS_HPP_ */
@@ -0,0 +1,242 @@
+/*
+ * xoshiro256_feeder.hpp
+ *
+ *  Moves generation off latency-critical threads. A background thread steps an
+ *  engine_array (so the SIMD path does the work) and pushes the values into a
+ *  lock-free ring; any number of consumer threads take values out in batches.
+ *
+ *  The producer keeps the ring between two watermarks: it fills up to the high
+ *  one, then sleeps until the consumers have drained it down to the low one. The
+ *  values come out in a fixed order (for each step of the array, lane 0 to lane
+ *  LANES-1), so the stream as a whole only depends on the seed; which consumer
+ *  gets which part of it depends on timing.
+ */
+#ifndef XOSHIRO256_FEEDER_HPP_
+#define XOSHIRO256_FEEDER_HPP_
+
+#include "xoshiro256_array.hpp"
+#include "xoshiro256_parallel.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ * class declaration for the feeder
+ */
+class random_feeder {
+public:
+	static const size_t LANES = 8; // engines stepped together by the producer
+	struct stats {
+		uint64_t produced; // values written to the ring
+		uint64_t empty_reads; // try_read calls that got nothing
+		uint64_t stalls; // times read() had to wait for the producer
+		uint64_t producer_sleeps; // times the producer reached the high watermark
+	};
+	random_feeder(size_t capacity, uint64_t seed); // watermarks at 1/4 and all of the ring
+	random_feeder(size_t capacity, uint64_t seed, size_t low, size_t high);
+	random_feeder(const random_feeder&) = delete;
+	random_feeder& operator=(const random_feeder&) = delete;
+	~random_feeder(); // stops and joins the producer
+	size_t try_read(uint64_t *out, size_t max); // takes up to max values without waiting, returns how many
+	void read(uint64_t *out, size_t n); // takes exactly n values, waiting if needed
+	uint64_t operator()(); // one value
+	size_t size() const; // values currently in the ring
+	stats statistics() const; // counters so far
+private:
+	struct cell {
+		std::atomic<uint64_t> seq; // position this cell may next be written at
+		uint64_t value;
+	};
+	void produce(); // body of the background thread
+	void start(size_t capacity, size_t low, size_t high);
+	size_t claim(uint64_t *out, size_t max); // try_read without the counter
+	size_t mask_; // capacity - 1, capacity being a power of two
+	size_t low_, high_; // watermarks
+	std::unique_ptr<cell[]> ring_;
+	engine_array engines_; // the producer's engines
+	alignas(XOSHIRO_CACHE_LINE) std::atomic<uint64_t> head_; // values published by the producer
+	alignas(XOSHIRO_CACHE_LINE) std::atomic<uint64_t> tail_; // values claimed by consumers
+	alignas(XOSHIRO_CACHE_LINE) std::atomic<uint64_t> empty_reads_;
+	std::atomic<uint64_t> stalls_;
+	std::atomic<uint64_t> producer_sleeps_;
+	std::atomic<bool> sleeping_; // producer is waiting on wake_
+	std::atomic<bool> stop_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::thread producer_;
+};
+
+#if XOSHIRO256_IMPL
+
+/*
+ * feeder with the default watermarks
+ */
+XOSHIRO256_DECL random_feeder::random_feeder(size_t capacity, uint64_t seed)
+	: engines_(LANES, seed) {
+	start(capacity, 0, 0);
+}
+
+/*
+ * feeder with explicit watermarks. capacity is rounded up to a power of two
+ */
+XOSHIRO256_DECL random_feeder::random_feeder(size_t capacity, uint64_t seed, size_t low, size_t high)
+	: engines_(LANES, seed) {
+	start(capacity, low, high);
+}
+
+/*
+ * sets up the ring and launches the producer
+ */
+XOSHIRO256_DECL void random_feeder::start(size_t capacity, size_t low, size_t high){
+	size_t cap = LANES;
+	while(cap < capacity)
+		cap *= 2;
+	mask_ = cap - 1;
+	high_ = (high == 0 || high > cap) ? cap : high;
+	low_ = (low == 0 || low >= high_) ? high_ / 4 : low;
+	ring_.reset(new cell[cap]);
+	for(size_t i = 0; i < cap; i++)
+		ring_[i].seq.store(i, std::memory_order_relaxed);
+	head_.store(0);
+	tail_.store(0);
+	empty_reads_.store(0);
+	stalls_.store(0);
+	producer_sleeps_.store(0);
+	sleeping_.store(false);
+	stop_.store(false);
+	producer_ = std::thread(&random_feeder::produce, this);
+}
+
+/*
+ * stops the producer
+ */
+XOSHIRO256_DECL random_feeder::~random_feeder(){
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_.store(true);
+	}
+	wake_.notify_one();
+	producer_.join();
+}
+
+/*
+ * the producer loop. a cell can only be rewritten once the consumer that claimed
+ * its previous value has copied it out and bumped seq.
+ */
+XOSHIRO256_DECL void random_feeder::produce(){
+	uint64_t buf[LANES];
+	uint64_t h = head_.load(std::memory_order_relaxed);
+	while(!stop_.load(std::memory_order_relaxed)){
+		if(h - tail_.load() >= high_){
+			std::unique_lock<std::mutex> lock(mutex_);
+			sleeping_.store(true);
+			producer_sleeps_.fetch_add(1, std::memory_order_relaxed);
+			wake_.wait(lock, [&]{ return stop_.load() || h - tail_.load() <= low_; });
+			sleeping_.store(false);
+			continue;
+		}
+		// one array step per round, published together
+		engines_.next(buf);
+		for(size_t k = 0; k < LANES; k++){
+			cell &c = ring_[(h + k) & mask_];
+			while(c.seq.load(std::memory_order_acquire) != h + k){
+				if(stop_.load(std::memory_order_relaxed))
+					return;
+				std::this_thread::yield();
+			}
+			c.value = buf[k];
+		}
+		h += LANES;
+		head_.store(h, std::memory_order_release);
+	}
+}
+
+/*
+ * non-blocking read
+ */
+XOSHIRO256_DECL size_t random_feeder::try_read(uint64_t *out, size_t max){
+	const size_t k = claim(out, max);
+	if(k == 0)
+		empty_reads_.fetch_add(1, std::memory_order_relaxed);
+	return k;
+}
+
+/*
+ * claims a batch with one compare-and-swap on the tail, then copies it out
+ */
+XOSHIRO256_DECL size_t random_feeder::claim(uint64_t *out, size_t max){
+	uint64_t t = tail_.load(std::memory_order_relaxed);
+	size_t k;
+	for(;;){
+		const uint64_t h = head_.load(std::memory_order_acquire);
+		if(h == t || max == 0)
+			return 0;
+		k = h - t < max ? h - t : max;
+		if(tail_.compare_exchange_weak(t, t + k))
+			break;
+	}
+	for(size_t i = 0; i < k; i++){
+		cell &c = ring_[(t + i) & mask_];
+		out[i] = c.value;
+		c.seq.store(t + i + mask_ + 1, std::memory_order_release);
+	}
+	if(sleeping_.load() && head_.load(std::memory_order_relaxed) - (t + k) <= low_){
+		std::lock_guard<std::mutex> lock(mutex_);
+		wake_.notify_one();
+	}
+	return k;
+}
+
+/*
+ * blocking read. every time the ring runs dry before n values are in counts as
+ * one stall, however long the wait for the producer.
+ */
+XOSHIRO256_DECL void random_feeder::read(uint64_t *out, size_t n){
+	bool waiting = false; // in a stall that is already counted
+	while(n){
+		const size_t k = claim(out, n);
+		if(k == 0){
+			if(!waiting)
+				stalls_.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::yield();
+		}
+		waiting = k == 0;
+		out += k;
+		n -= k;
+	}
+}
+
+/*
+ * a single value
+ */
+XOSHIRO256_DECL uint64_t random_feeder::operator()(){
+	uint64_t v;
+	read(&v, 1);
+	return v;
+}
+
+/*
+ * current fill level
+ */
+XOSHIRO256_DECL size_t random_feeder::size() const{
+	return head_.load() - tail_.load();
+}
+
+/*
+ * snapshot of the counters. produced counts what has been published.
+ */
+XOSHIRO256_DECL random_feeder::stats random_feeder::statistics() const{
+	stats st;
+	st.produced = head_.load();
+	st.empty_reads = empty_reads_.load();
+	st.stalls = stalls_.load();
+	st.producer_sleeps = producer_sleeps_.load();
+	return st;
+}
+
+#endif /* XOSHIRO256_IMPL */
+
+#endif /* XOSHIRO256_FEEDER_HPP_ */
@@ -0,0 +1,286 @@
+/*
+ * xoshiro256_instrument.hpp
+ *
+ *  Counts of what the engines are asked for, to find out which parts of a
+ *  program consume the most randomness and how often uniform() has to retry.
+ *  Compile everything with -DXOSHIRO_INSTRUMENT to switch it on. Every engine
+ *  (all the instances of the engine template, xoshiro256ss to xoroshiro1024s)
+ *  then counts its draws, uniform() retries, jumps and distribution calls.
+ *  Without the macro the engines have no counters and the functions below do
+ *  nothing, so the calls can stay in the code.
+ *
+ *      xoshiro256ss e;
+ *      xoshiro_instrument::label(e, "collisions");
+ *      xoshiro_instrument::dump_at_exit();
+ *
+ *  Counts are aggregated per label. A copy of an engine keeps its label, and an
+ *  engine without a label is counted under "(unlabeled)". Labeling registers an
+ *  engine: the registry reads the labeled engines when asked, so their counts
+ *  are up to date in any dump, and keeps the totals of the destroyed ones. That
+ *  costs a mutex when a labeled engine is labeled, copied or destroyed. Engines
+ *  nobody labeled, such as the temporary ones the bulk paths build, cost a few
+ *  atomic adds when they are destroyed and nothing before, and show up in a dump
+ *  once they are gone. The macro changes the layout of the classes, so every
+ *  translation unit must agree on it.
+ *
+ *  engine_array, interleaved and the feeder step their own copies of the state
+ *  and aren't counted.
+ */
+#ifndef XOSHIRO256_INSTRUMENT_HPP_
+#define XOSHIRO256_INSTRUMENT_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifdef XOSHIRO_INSTRUMENT
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#endif
+
+namespace xoshiro_instrument {
+
+/*
+ * the counts of one label
+ */
+struct totals {
+	std::string label; // the label, or "(unlabeled)"
+	uint64_t engines = 0; // engines that ever had this label
+	uint64_t draws = 0; // calls to () and previous()
+	uint64_t uniform_retries = 0; // values uniform() rejected
+	uint64_t jumps = 0; // calls to jump, long_jump, advance and retreat
+	uint64_t uniform = 0; // calls to uniform, including those from exponential and geometric
+	uint64_t exponential = 0; // calls to exponential
+	uint64_t geometric = 0; // calls to geometric
+};
+
+void label(xoshiro_detail::engine_hooks &e, const char *name); // counts e under name from now on. name must outlive e
+std::vector<totals> snapshot(); // the counts so far, one entry per label
+void dump(FILE *f = stderr); // prints snapshot() as a table
+void dump_at_exit(); // calls dump() when the program exits
+
+} // namespace xoshiro_instrument
+
+#ifdef XOSHIRO_INSTRUMENT
+
+namespace xoshiro_detail {
+
+/*
+ * class declaration for the registry of labeled engines and retired counts
+ */
+class instrument_registry {
+public:
+	static instrument_registry& get(); // the process-wide registry
+	void attach(engine_hooks *e); // starts tracking e if it has a label
+	void detach(engine_hooks *e); // folds e's counts into its label's totals
+	void relabel(engine_hooks *e, const char *name); // moves e to another label, null for none
+	std::vector<xoshiro_instrument::totals> snapshot(); // retired totals plus the live engines
+private:
+	static void add(xoshiro_instrument::totals &t, const engine_hooks *e); // adds e's counts to t
+	static bool counted(const engine_hooks *e); // true if e has drawn or jumped
+	void retire_unlabeled(const engine_hooks *e); // adds e's counts to unlabeled_, without the lock
+	draw_counters unlabeled_; // counts of destroyed engines without a label
+	std::atomic<uint64_t> unlabeled_engines_{0}; // how many of them counted anything
+	std::mutex mutex_; // guards everything below
+	std::set<engine_hooks*> live_; // labeled engines not yet destroyed
+	std::map<std::string, xoshiro_instrument::totals> retired_; // counts of destroyed labeled engines by label
+};
+
+} // namespace xoshiro_detail
+
+#if XOSHIRO256_IMPL
+
+namespace xoshiro_detail {
+
+/*
+ * constructed by the first engine, see attach()
+ */
+XOSHIRO256_DECL instrument_registry& instrument_registry::get(){
+	static instrument_registry r;
+	return r;
+}
+
+XOSHIRO256_DECL void instrument_registry::attach(engine_hooks *e){
+	if(!e->label_)
+		return;
+	std::lock_guard<std::mutex> lock(mutex_);
+	live_.insert(e);
+}
+
+/*
+ * an unlabeled engine never took the lock, and doesn't take it here either
+ */
+XOSHIRO256_DECL void instrument_registry::detach(engine_hooks *e){
+	if(!e->label_){
+		retire_unlabeled(e);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	live_.erase(e);
+	xoshiro_instrument::totals &t = retired_[e->label_];
+	add(t, e);
+	t.engines++;
+}
+
+/*
+ * what e counted so far stays with the old label as if e had been destroyed and
+ * a fresh engine made in its place
+ */
+XOSHIRO256_DECL void instrument_registry::relabel(engine_hooks *e, const char *name){
+	std::lock_guard<std::mutex> lock(mutex_);
+	if(counted(e)){
+		if(e->label_){
+			xoshiro_instrument::totals &t = retired_[e->label_];
+			add(t, e);
+			t.engines++;
+		} else {
+			retire_unlabeled(e);
+		}
+		e->counters_.draws.store(0, std::memory_order_relaxed);
+		e->counters_.uniform_retries.store(0, std::memory_order_relaxed);
+		e->counters_.jumps.store(0, std::memory_order_relaxed);
+		e->counters_.uniform.store(0, std::memory_order_relaxed);
+		e->counters_.exponential.store(0, std::memory_order_relaxed);
+		e->counters_.geometric.store(0, std::memory_order_relaxed);
+	}
+	e->label_ = name;
+	if(name)
+		live_.insert(e);
+	else
+		live_.erase(e);
+}
+
+/*
+ * live engines may be drawing while this runs, so their counts are a moment's
+ * reading, each counter on its own
+ */
+XOSHIRO256_DECL std::vector<xoshiro_instrument::totals> instrument_registry::snapshot(){
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::map<std::string, xoshiro_instrument::totals> all(retired_);
+	for(engine_hooks *e : live_){
+		xoshiro_instrument::totals &t = all[e->label_];
+		add(t, e);
+		t.engines++;
+	}
+	if(const uint64_t n = unlabeled_engines_.load(std::memory_order_relaxed)){
+		xoshiro_instrument::totals &t = all["(unlabeled)"];
+		t.engines += n;
+		t.draws += unlabeled_.draws.load(std::memory_order_relaxed);
+		t.uniform_retries += unlabeled_.uniform_retries.load(std::memory_order_relaxed);
+		t.jumps += unlabeled_.jumps.load(std::memory_order_relaxed);
+		t.uniform += unlabeled_.uniform.load(std::memory_order_relaxed);
+		t.exponential += unlabeled_.exponential.load(std::memory_order_relaxed);
+		t.geometric += unlabeled_.geometric.load(std::memory_order_relaxed);
+	}
+	std::vector<xoshiro_instrument::totals> out;
+	for(auto &kv : all){
+		kv.second.label = kv.first;
+		out.push_back(kv.second);
+	}
+	return out;
+}
+
+XOSHIRO256_DECL void instrument_registry::add(xoshiro_instrument::totals &t, const engine_hooks *e){
+	const draw_counters &c = e->counters_;
+	t.draws += c.draws.load(std::memory_order_relaxed);
+	t.uniform_retries += c.uniform_retries.load(std::memory_order_relaxed);
+	t.jumps += c.jumps.load(std::memory_order_relaxed);
+	t.uniform += c.uniform.load(std::memory_order_relaxed);
+	t.exponential += c.exponential.load(std::memory_order_relaxed);
+	t.geometric += c.geometric.load(std::memory_order_relaxed);
+}
+
+XOSHIRO256_DECL bool instrument_registry::counted(const engine_hooks *e){
+	return e->counters_.draws.load(std::memory_order_relaxed) || e->counters_.jumps.load(std::memory_order_relaxed);
+}
+
+/*
+ * an engine that only ever existed (the bulk paths build a few to read states
+ * from) doesn't count as one
+ */
+XOSHIRO256_DECL void instrument_registry::retire_unlabeled(const engine_hooks *e){
+	if(!counted(e))
+		return;
+	const draw_counters &c = e->counters_;
+	unlabeled_.draws.fetch_add(c.draws.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	unlabeled_.uniform_retries.fetch_add(c.uniform_retries.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	unlabeled_.jumps.fetch_add(c.jumps.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	unlabeled_.uniform.fetch_add(c.uniform.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	unlabeled_.exponential.fetch_add(c.exponential.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	unlabeled_.geometric.fetch_add(c.geometric.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	unlabeled_engines_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+ * called by the engine constructors. the registry is made by the first engine
+ * either way, so it outlives every engine with static storage duration, but
+ * only a labeled copy is tracked
+ */
+XOSHIRO256_DECL void attach(engine_hooks *e){
+	instrument_registry::get().attach(e);
+}
+
+/*
+ * called by the engine destructor
+ */
+XOSHIRO256_DECL void detach(engine_hooks *e){
+	instrument_registry::get().detach(e);
+}
+
+} // namespace xoshiro_detail
+
+namespace xoshiro_instrument {
+
+XOSHIRO256_DECL void label(xoshiro_detail::engine_hooks &e, const char *name){
+	xoshiro_detail::instrument_registry::get().relabel(&e, name);
+}
+
+XOSHIRO256_DECL std::vector<totals> snapshot(){
+	return xoshiro_detail::instrument_registry::get().snapshot();
+}
+
+/*
+ * one line per label, biggest consumers of draws first
+ */
+XOSHIRO256_DECL void dump(FILE *f){
+	std::vector<totals> t = snapshot();
+	std::sort(t.begin(), t.end(), [](const totals &a, const totals &b){ return a.draws > b.draws; });
+	fprintf(f, "%-24s %8s %14s %14s %10s %12s %12s %10s\n", "label", "engines", "draws",
+			"uniform", "retries", "exponential", "geometric", "jumps");
+	for(const totals &x : t)
+		fprintf(f, "%-24s %8llu %14llu %14llu %10llu %12llu %12llu %10llu\n", x.label.c_str(),
+				(unsigned long long)x.engines, (unsigned long long)x.draws, (unsigned long long)x.uniform,
+				(unsigned long long)x.uniform_retries, (unsigned long long)x.exponential,
+				(unsigned long long)x.geometric, (unsigned long long)x.jumps);
+}
+
+/*
+ * the registry is created before the handler is installed, so it is still
+ * there when the handler runs. the handler is installed once however often
+ * this is called.
+ */
+XOSHIRO256_DECL void dump_at_exit(){
+	static const int installed = (xoshiro_detail::instrument_registry::get(), std::atexit([]{ dump(stderr); }));
+	(void)installed;
+}
+
+} // namespace xoshiro_instrument
+
+#endif /* XOSHIRO256_IMPL */
+
+#else
+
+namespace xoshiro_instrument {
+
+inline void label(xoshiro_detail::engine_hooks &, const char *){}
+inline std::vector<totals> snapshot(){ return std::vector<totals>(); }
+inline void dump(FILE *){}
+inline void dump_at_exit(){}
+
+} // namespace xoshiro_instrument
+
+#endif /* XOSHIRO_INSTRUMENT */
+#endif /* XOSHIRO256_INSTRUMENT_HPP_ */
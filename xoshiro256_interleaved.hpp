@@ -0,0 +1,244 @@
+/*
+ * xoshiro256_interleaved.hpp
+ *
+ *  N independent states of an engine stepped in lockstep, laid out so that
+ *  word w of all N states is one contiguous row. One step of xoshiro256** is a
+ *  short chain where every operation waits on the previous one, so a single
+ *  stream leaves most of a superscalar core idle. Running 2 to 4 streams side
+ *  by side in plain scalar code lets the core overlap their chains, which helps
+ *  on any 64-bit target, with or without SIMD. With the 32-bit engines and 8 or
+ *  16 streams the compiler turns the loops over the streams into one vector
+ *  operation per row instead, see xoshiro128_lanes.hpp.
+ *
+ *  Engine is any engine: xoshiro256ss (the default), xoshiro256p, the
+ *  xoshiro128 and xoshiro512 ones or xoroshiro1024; its family gives the state
+ *  transition and its scrambler the output. The streams move in lockstep, so
+ *  for xoroshiro1024 they share one ring start. Stream j is the base engine
+ *  after j jumps. The outputs are handed out round robin: value k*N+j of
+ *  interleaved<N> is value k of stream j. So interleaved<1> is exactly the
+ *  engine, and interleaved<N> from base gives the same values as N engine
+ *  copies jumped 0..N-1 times read in turn.
+ */
+#ifndef XOSHIRO256_INTERLEAVED_HPP_
+#define XOSHIRO256_INTERLEAVED_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <cstddef>
+#include <limits>
+
+namespace xoshiro_detail {
+
+/*
+ * one stream of a state laid out in rows, indexed like an engine's state
+ * array, so the family functions step it in place
+ */
+template <class Word, unsigned N>
+struct lane_ref {
+	Word (*rows)[N]; // rows[w][j] is word w of stream j
+	unsigned j; // the stream
+	Word& operator[](unsigned w) const { return rows[w][j]; }
+};
+
+} // namespace xoshiro_detail
+
+/*
+ * class declaration for the interleaved engine
+ */
+template <unsigned N, class Engine = xoshiro256ss>
+class interleaved {
+public:
+	typedef typename Engine::family family; // the state transition
+	typedef typename Engine::scrambler scrambler; // the output function
+	typedef typename family::word word; // the type of a state word and of a value
+	typedef typename xoshiro_detail::uniform_conversion<word>::real real; // what uniform() returns
+	static_assert(N >= 1, "interleaved<N> needs at least one stream");
+	word min() const { return 0; } // returns 0
+	word max() const { return std::numeric_limits<word>::max(); } // returns the max word value
+	interleaved(const Engine &base); // stream j is base after j jumps
+	word operator()(); // next value in round-robin order. compatible with random's distributions
+	real uniform(real low, real high); // the next value as Engine::uniform() would convert it
+	void fill(word *out, size_t n); // same as n calls to ()
+	void fill_uniform(real *out, size_t n, real low, real high); // same as n calls to uniform()
+	void jump(); // jumps every stream
+	void long_jump(); // long jumps every stream
+	Engine stream(unsigned j) const; // copy of stream j's current state
+	alignas(64) word s[family::words][N]; // s[w][j] is word w of stream j
+private:
+	typedef xoshiro_detail::lane_ref<word, N> lane; // stream j of a set of rows
+	template <class T, class Convert>
+	void generate(T *out, size_t n, Convert convert); // the body of fill and fill_uniform
+	void step(word *out); // steps all streams, out[j] from stream j
+	word buf_[N]; // outputs of the last step
+	unsigned pos_; // next value in buf_, N when empty
+	unsigned p_; // ring start of every stream, 0 when the family has no ring
+};
+
+/*
+ * lays the jumped copies of base side by side
+ */
+template <unsigned N, class Engine>
+interleaved<N, Engine>::interleaved(const Engine &base) : pos_(N), p_(0) {
+	word w[family::words];
+	base.get_state(w);
+	for(unsigned j = 0; j < N; j++){
+		for(unsigned v = 0; v < family::words; v++)
+			s[v][j] = w[v];
+		xoshiro_detail::apply_poly<family>(w, 0, family::jump_poly(), 0);
+	}
+}
+
+/*
+ * one step of every stream. the j loop has no dependency between iterations,
+ * so the compiler can schedule the N chains together or vectorize them.
+ */
+template <unsigned N, class Engine>
+void interleaved<N, Engine>::step(word *out){
+	const unsigned p = p_;
+	unsigned q = p;
+	for(unsigned j = 0; j < N; j++){
+		const lane l = { s, j };
+		out[j] = scrambler::scramble(l, p);
+		q = family::step(l, p);
+	}
+	p_ = q;
+}
+
+/*
+ * round robin over the last step's outputs
+ */
+template <unsigned N, class Engine>
+typename interleaved<N, Engine>::word interleaved<N, Engine>::operator()(){
+	if(pos_ == N){
+		step(buf_);
+		pos_ = 0;
+	}
+	return buf_[pos_++];
+}
+
+/*
+ * the values a stream's uniform() would reject are skipped here as well, so
+ * the result is the one of Engine::uniform() on the round-robin sequence
+ */
+template <unsigned N, class Engine>
+typename interleaved<N, Engine>::real interleaved<N, Engine>::uniform(real low, real high){
+	typedef xoshiro_detail::uniform_conversion<word> conversion;
+	word n = (*this)();
+	while(conversion::rejected(n))
+		n = (*this)();
+	return conversion::convert(n, low, high);
+}
+
+template <unsigned N, class Engine>
+void interleaved<N, Engine>::fill(word *out, size_t n){
+	generate(out, n, [](word v){ return v; });
+}
+
+/*
+ * the conversion happens in the same loop as the steps, so it is vectorized
+ * with them and the raw values never go to memory. that needs a conversion
+ * without rejections, the 32-bit one; the 64-bit one takes the values one by
+ * one.
+ */
+template <unsigned N, class Engine>
+void interleaved<N, Engine>::fill_uniform(real *out, size_t n, real low, real high){
+	typedef xoshiro_detail::uniform_conversion<word> conversion;
+	if(conversion::rejects){
+		while(n--)
+			*out++ = uniform(low, high);
+		return;
+	}
+	generate(out, n, [low, high](word v){ return conversion::convert(v, low, high); });
+}
+
+/*
+ * whole steps are written straight into out, only the ends go through the
+ * buffer. the state is copied into locals for the main loop: out could point
+ * into s as far as the compiler knows, which would force every word back to
+ * memory on every step. each stream's words go through an array of their own
+ * around the step, which GCC keeps in registers where it would spill rows
+ * indexed through a lane. at -O3 GCC unrolls an 8-lane 32-bit body completely
+ * before it gets to vectorize it, which leaves scalar code 8 times slower than
+ * the vector loop; the pragma stops that (clang knows it too, other compilers
+ * ignore it).
+ */
+template <unsigned N, class Engine>
+template <class T, class Convert>
+void interleaved<N, Engine>::generate(T *out, size_t n, Convert convert){
+	while(n && pos_ != N){
+		*out++ = convert(buf_[pos_++]);
+		n--;
+	}
+	alignas(64) word t[family::words][N];
+	for(unsigned w = 0; w < family::words; w++)
+		for(unsigned j = 0; j < N; j++)
+			t[w][j] = s[w][j];
+	unsigned p = p_;
+	for(; n >= N; n -= N, out += N){
+		unsigned q = p;
+#pragma GCC unroll 1
+		for(unsigned j = 0; j < N; j++){
+			word x[family::words];
+			for(unsigned w = 0; w < family::words; w++)
+				x[w] = t[w][j];
+			out[j] = convert(scrambler::scramble(x, p));
+			q = family::step(x, p);
+			for(unsigned w = 0; w < family::words; w++)
+				t[w][j] = x[w];
+		}
+		p = q;
+	}
+	p_ = p;
+	for(unsigned w = 0; w < family::words; w++)
+		for(unsigned j = 0; j < N; j++)
+			s[w][j] = t[w][j];
+	while(n--)
+		*out++ = convert((*this)());
+}
+
+/*
+ * jumps every stream. buffered values are dropped, so the next value is the
+ * first one of stream 0 after the jump.
+ */
+template <unsigned N, class Engine>
+void interleaved<N, Engine>::jump(){
+	word w[family::words];
+	for(unsigned j = 0; j < N; j++){
+		Engine e = stream(j);
+		e.jump();
+		e.get_state(w);
+		for(unsigned v = 0; v < family::words; v++)
+			s[v][j] = w[v];
+	}
+	p_ = 0;
+	pos_ = N;
+}
+
+/*
+ * long jumps every stream, see jump()
+ */
+template <unsigned N, class Engine>
+void interleaved<N, Engine>::long_jump(){
+	word w[family::words];
+	for(unsigned j = 0; j < N; j++){
+		Engine e = stream(j);
+		e.long_jump();
+		e.get_state(w);
+		for(unsigned v = 0; v < family::words; v++)
+			s[v][j] = w[v];
+	}
+	p_ = 0;
+	pos_ = N;
+}
+
+/*
+ * stream j as a regular engine, its words from the ring start on
+ */
+template <unsigned N, class Engine>
+Engine interleaved<N, Engine>::stream(unsigned j) const{
+	word w[family::words];
+	for(unsigned v = 0; v < family::words; v++)
+		w[v] = s[(v + p_) & (family::words - 1)][j];
+	return Engine(w);
+}
+
+#endif /* XOSHIRO256_INTERLEAVED_HPP_ */
@@ -0,0 +1,315 @@
+/*
+ * xoshiro256_io.hpp
+ *
+ *  Text forms of 64-bit values and engine states, for debug logs and for
+ *  saving and restoring states. Kept out of the core header so that engines
+ *  don't drag <string> into every translation unit.
+ *
+ *  The formatters work like std::to_chars: they write into the caller's buffer
+ *  [first, last), allocate nothing and return the end of what they wrote, or
+ *  null if the buffer is too small. Unlike to_chars the width is fixed (leading
+ *  zeros are written), so a dump of many values lines up and can be read back
+ *  without separators. The digits come from small tables, a nibble or a byte at
+ *  a time. The parsers take the same fixed widths and return the end of what
+ *  they read, or null if the text isn't valid.
+ *
+ *      char buf[xoshiro_io::STATE_CHARS];
+ *      xoshiro_io::to_hex(buf, buf + sizeof(buf), engine);
+ */
+#ifndef XOSHIRO256_IO_HPP_
+#define XOSHIRO256_IO_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <cstring>
+#include <string>
+
+namespace xoshiro_io {
+
+/*
+ * characters each formatter writes. an enum rather than constants so the
+ * values have linkage the module interface can export.
+ */
+enum io_sizes : size_t {
+	BINARY_CHARS = 64, // to_binary: one digit per bit
+	HEX_CHARS = 16, // to_hex of a value
+	BASE64_CHARS = 11, // to_base64: the 8 bytes in unpadded base64
+	STATE_CHARS = 64 // to_hex of an xoshiro256 engine: s[0] to s[3], 16 digits each
+};
+
+/*
+ * characters to_hex writes for an engine of any family: 16 per 64 bits of
+ * state
+ */
+template <class Engine>
+constexpr size_t state_chars() {
+	return 16 * xoshiro_detail::field_words<typename Engine::family>();
+}
+
+char* to_binary(char *first, char *last, uint64_t v); // 64 '0' and '1', most significant bit first
+char* to_hex(char *first, char *last, uint64_t v); // 16 lowercase hex digits, most significant first
+char* to_base64(char *first, char *last, uint64_t v); // the 8 big-endian bytes in base64 without '=' padding
+template <class Family>
+char* to_hex(char *first, char *last, const xoshiro_engine<Family> &e); // the words in logical order, state_chars() hex digits
+const char* from_binary(const char *first, const char *last, uint64_t &v); // reads 64 binary digits
+const char* from_hex(const char *first, const char *last, uint64_t &v); // reads 16 hex digits of either case
+const char* from_base64(const char *first, const char *last, uint64_t &v); // reads 11 base64 characters
+template <class Family>
+const char* from_hex(const char *first, const char *last, xoshiro_engine<Family> &e); // reads a state, rejects all zeros
+
+} // namespace xoshiro_io
+
+namespace xoshiro_detail {
+
+/*
+ * an engine's words in logical order as the 64-bit pieces of its text form:
+ * the words themselves, or two 32-bit words each with the first one on top, so
+ * the digits come out word by word either way. n is the number of words.
+ */
+inline void to_chunks(const uint64_t *w, unsigned n, uint64_t *c){
+	for(unsigned i = 0; i < n; i++)
+		c[i] = w[i];
+}
+
+inline void to_chunks(const uint32_t *w, unsigned n, uint64_t *c){
+	for(unsigned i = 0; i < n / 2; i++)
+		c[i] = (uint64_t)w[2*i] << 32 | w[2*i+1];
+}
+
+/*
+ * the inverse of to_chunks()
+ */
+inline void from_chunks(const uint64_t *c, unsigned n, uint64_t *w){
+	for(unsigned i = 0; i < n; i++)
+		w[i] = c[i];
+}
+
+inline void from_chunks(const uint64_t *c, unsigned n, uint32_t *w){
+	for(unsigned i = 0; i < n / 2; i++){
+		w[2*i] = (uint32_t)(c[i] >> 32);
+		w[2*i+1] = (uint32_t)c[i];
+	}
+}
+
+} // namespace xoshiro_detail
+
+namespace xoshiro_io {
+
+/*
+ * each 64 bits of the state as to_hex of a value, the words in the order of
+ * get_state()
+ */
+template <class Family>
+char* to_hex(char *first, char *last, const xoshiro_engine<Family> &e){
+	enum : unsigned { n = xoshiro_detail::field_words<Family>() };
+	if(last - first < (ptrdiff_t)(16*n))
+		return nullptr;
+	typename Family::word w[Family::words];
+	uint64_t c[n];
+	e.get_state(w);
+	xoshiro_detail::to_chunks(w, Family::words, c);
+	for(unsigned i = 0; i < n; i++)
+		first = to_hex(first, last, c[i]);
+	return first;
+}
+
+/*
+ * e is only changed if the whole state is valid. it starts at p = 0, which
+ * matters for a ring only.
+ */
+template <class Family>
+const char* from_hex(const char *first, const char *last, xoshiro_engine<Family> &e){
+	enum : unsigned { n = xoshiro_detail::field_words<Family>() };
+	uint64_t c[n], any = 0;
+	for(unsigned i = 0; i < n; i++){
+		if(!(first = from_hex(first, last, c[i])))
+			return nullptr;
+		any |= c[i];
+	}
+	if(any == 0)
+		return nullptr;
+	typename Family::word w[Family::words];
+	xoshiro_detail::from_chunks(c, Family::words, w);
+	e.set_state(w);
+	return first;
+}
+
+} // namespace xoshiro_io
+
+namespace xoshiro_detail {
+
+/*
+ * the tables of the formatters and parsers. static members of a class template
+ * can be defined in a header without breaking the one definition rule, which
+ * C++11 has no inline variables for. the parser tables cover ASCII, 255 marks a
+ * character that isn't a digit.
+ */
+template <class T = void>
+struct io_tables {
+	static const char binary[65]; // the four binary digits of each nibble
+	static const char hex[513]; // the two hex digits of each byte
+	static const char base64[65]; // the base64 alphabet
+	static const unsigned char hex_value[128]; // digit values of either case
+	static const unsigned char base64_value[128]; // positions in the alphabet
+};
+
+template <class T>
+const char io_tables<T>::binary[65] = "0000000100100011010001010110011110001001101010111100110111101111";
+
+template <class T>
+const char io_tables<T>::hex[513] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+template <class T>
+const char io_tables<T>::base64[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+template <class T>
+const unsigned char io_tables<T>::hex_value[128] = {
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	  0,   1,   2,   3,   4,   5,   6,   7,   8,   9, 255, 255, 255, 255, 255, 255,
+	255,  10,  11,  12,  13,  14,  15, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255,  10,  11,  12,  13,  14,  15, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+
+template <class T>
+const unsigned char io_tables<T>::base64_value[128] = {
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255, 255,  63,
+	 52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,
+	255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+	 15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255, 255,
+	255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+	 41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255
+};
+
+} // namespace xoshiro_detail
+
+std::string UI64T2String(uint64_t input); // the 64 bits of input as a string of 0s and 1s, for debugging
+
+#if XOSHIRO256_IMPL
+
+namespace xoshiro_io {
+
+/*
+ * four digits per nibble
+ */
+XOSHIRO256_DECL char* to_binary(char *first, char *last, uint64_t v){
+	if(last - first < (ptrdiff_t)BINARY_CHARS)
+		return nullptr;
+	for(int i = 0; i < 16; i++)
+		memcpy(first + 4*i, xoshiro_detail::io_tables<>::binary + 4*((v >> (60 - 4*i)) & 0xf), 4);
+	return first + BINARY_CHARS;
+}
+
+/*
+ * two digits per byte
+ */
+XOSHIRO256_DECL char* to_hex(char *first, char *last, uint64_t v){
+	if(last - first < (ptrdiff_t)HEX_CHARS)
+		return nullptr;
+	for(int i = 0; i < 8; i++)
+		memcpy(first + 2*i, xoshiro_detail::io_tables<>::hex + 2*((v >> (56 - 8*i)) & 0xff), 2);
+	return first + HEX_CHARS;
+}
+
+/*
+ * ten characters of 6 bits, then the last 4 bits shifted up as base64 pads a
+ * final partial group with zero bits. the result is what a base64 encoder
+ * gives for the 8 bytes, minus the trailing '='.
+ */
+XOSHIRO256_DECL char* to_base64(char *first, char *last, uint64_t v){
+	const char *alphabet = xoshiro_detail::io_tables<>::base64;
+	if(last - first < (ptrdiff_t)BASE64_CHARS)
+		return nullptr;
+	for(int i = 0; i < 10; i++)
+		first[i] = alphabet[(v >> (58 - 6*i)) & 0x3f];
+	first[10] = alphabet[(v & 0xf) << 2];
+	return first + BASE64_CHARS;
+}
+
+XOSHIRO256_DECL const char* from_binary(const char *first, const char *last, uint64_t &v){
+	if(last - first < (ptrdiff_t)BINARY_CHARS)
+		return nullptr;
+	uint64_t x = 0;
+	unsigned bad = 0;
+	for(size_t i = 0; i < BINARY_CHARS; i++){
+		const unsigned d = (unsigned char)first[i] - '0';
+		x = x << 1 | (d & 1);
+		bad |= d;
+	}
+	if(bad > 1)
+		return nullptr;
+	v = x;
+	return first + BINARY_CHARS;
+}
+
+/*
+ * the digits are checked once at the end rather than one by one, so mixed
+ * letters and numbers cost no mispredicted branches. characters outside ASCII
+ * are caught by their high bit.
+ */
+XOSHIRO256_DECL const char* from_hex(const char *first, const char *last, uint64_t &v){
+	if(last - first < (ptrdiff_t)HEX_CHARS)
+		return nullptr;
+	uint64_t x = 0;
+	unsigned bad = 0;
+	for(size_t i = 0; i < HEX_CHARS; i++){
+		const unsigned c = (unsigned char)first[i];
+		const unsigned d = xoshiro_detail::io_tables<>::hex_value[c & 0x7f];
+		x = x << 4 | (d & 0xf);
+		bad |= d | c;
+	}
+	if(bad & 0x80)
+		return nullptr;
+	v = x;
+	return first + HEX_CHARS;
+}
+
+/*
+ * the two bits the last character carries beyond the value must be zero, so
+ * every value has exactly one encoding
+ */
+XOSHIRO256_DECL const char* from_base64(const char *first, const char *last, uint64_t &v){
+	if(last - first < (ptrdiff_t)BASE64_CHARS)
+		return nullptr;
+	uint64_t x = 0;
+	unsigned bad = 0;
+	for(int i = 0; i < 10; i++){
+		const unsigned c = (unsigned char)first[i];
+		const unsigned d = xoshiro_detail::io_tables<>::base64_value[c & 0x7f];
+		x = x << 6 | (d & 0x3f);
+		bad |= d | c;
+	}
+	const unsigned c = (unsigned char)first[10];
+	const unsigned d = xoshiro_detail::io_tables<>::base64_value[c & 0x7f];
+	if(((bad | d | c) & 0x80) || (d & 3))
+		return nullptr;
+	v = x << 4 | d >> 2;
+	return first + BASE64_CHARS;
+}
+
+} // namespace xoshiro_io
+
+/*
+ * converts uint64_t to strings. this is helpful for debugging.
+ */
+XOSHIRO256_DECL std::string UI64T2String(uint64_t input){
+	std::string result(xoshiro_io::BINARY_CHARS, '0');
+	xoshiro_io::to_binary(&result[0], &result[0] + result.size(), input);
+	return result;
+}
+
+#endif /* XOSHIRO256_IMPL */
+
+#endif /* XOSHIRO256_IO_HPP_ */
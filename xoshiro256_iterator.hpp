@@ -0,0 +1,108 @@
+/*
+ * xoshiro256_iterator.hpp
+ *
+ *  A bidirectional iterator over the values of an engine. The iterator holds
+ *  its own copy of the engine, so it can be copied, compared and walked in
+ *  both directions like an iterator into a container of every value the
+ *  engine will ever produce, with no memory for the values:
+ *
+ *      engine_iterator<xoshiro256ss> it(e);   // *it is what e() would return
+ *      ++it; ++it;
+ *      --it;                                  // the same values again
+ *
+ *  The engine the iterator was made from is left alone. Two iterators are
+ *  equal when they sit at the same point of the same stream; the engines have
+ *  a single cycle, so that is when their states are equal. ++ costs one step,
+ *  -- three (back over the current value, back over the one before to read it,
+ *  and forward again).
+ */
+#ifndef XOSHIRO256_ITERATOR_HPP_
+#define XOSHIRO256_ITERATOR_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <cstddef>
+#include <iterator>
+
+/*
+ * class declaration for the iterator. Engine is any of the engines, and the
+ * values are its words: 32 bits for xoshiro128, 64 for the others.
+ */
+template <class Engine>
+class engine_iterator {
+public:
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = typename Engine::word;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const value_type*;
+	using reference = const value_type&;
+	explicit engine_iterator(const Engine &e); // *this is the value e() would return next
+	reference operator*() const { return value_; } // the current value
+	pointer operator->() const { return &value_; }
+	engine_iterator& operator++(); // the next value
+	engine_iterator operator++(int);
+	engine_iterator& operator--(); // the previous value
+	engine_iterator operator--(int);
+	const Engine& engine() const { return e_; } // positioned just past the current value
+	bool operator==(const engine_iterator &o) const;
+	bool operator!=(const engine_iterator &o) const { return !(*this == o); }
+private:
+	Engine e_; // the state after producing value_
+	value_type value_; // the current value
+};
+
+/*
+ * draws the first value from the copy
+ */
+template <class Engine>
+engine_iterator<Engine>::engine_iterator(const Engine &e) : e_(e) {
+	value_ = e_.Engine::operator()();
+}
+
+template <class Engine>
+engine_iterator<Engine>& engine_iterator<Engine>::operator++(){
+	value_ = e_.Engine::operator()();
+	return *this;
+}
+
+template <class Engine>
+engine_iterator<Engine> engine_iterator<Engine>::operator++(int){
+	engine_iterator old(*this);
+	++*this;
+	return old;
+}
+
+/*
+ * the state has to end up just past the previous value, and the only way to
+ * read a value is to step over it
+ */
+template <class Engine>
+engine_iterator<Engine>& engine_iterator<Engine>::operator--(){
+	e_.Engine::previous();
+	e_.Engine::previous();
+	value_ = e_.Engine::operator()();
+	return *this;
+}
+
+template <class Engine>
+engine_iterator<Engine> engine_iterator<Engine>::operator--(int){
+	engine_iterator old(*this);
+	--*this;
+	return old;
+}
+
+/*
+ * the value follows from the state, so it isn't compared. the states are
+ * compared in logical order, which takes care of a ring's start
+ */
+template <class Engine>
+bool engine_iterator<Engine>::operator==(const engine_iterator &o) const{
+	typename Engine::word a[Engine::family::words], b[Engine::family::words];
+	e_.get_state(a);
+	o.e_.get_state(b);
+	for(unsigned w = 0; w < Engine::family::words; w++)
+		if(a[w] != b[w])
+			return false;
+	return true;
+}
+
+#endif /* XOSHIRO256_ITERATOR_HPP_ */
@@ -0,0 +1,221 @@
+/*
+ * xoshiro256_parallel.hpp
+ *
+ *  Multi-threaded helpers built on top of xoshiro256_core.hpp.
+ *
+ *  parallel_fill writes the same values whatever the number of threads: the
+ *  output is cut into fixed-size blocks, every block gets its own copy of the
+ *  engine moved to the start of that block with advance(), and the blocks are
+ *  handed out to the threads through a shared counter. The buffer therefore
+ *  always holds the first n outputs of one engine seeded from the given seed,
+ *  exactly what a single thread calling operator() n times would produce.
+ *
+ *  per_thread_engines gives every thread its own engine on its own cache line
+ *  (or page), so threads drawing at the same time never write to a line another
+ *  thread is writing to.
+ */
+#ifndef XOSHIRO256_PARALLEL_HPP_
+#define XOSHIRO256_PARALLEL_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+/*
+ * size of the unit two cores can contend on. 64 on everything current; some
+ * parts prefetch pairs of lines, in which case defining this as 128 helps.
+ */
+#ifndef XOSHIRO_CACHE_LINE
+#define XOSHIRO_CACHE_LINE 64
+#endif
+
+namespace xoshiro_detail {
+
+/*
+ * the unit first-touch placement works in. 4096 where it can't be asked
+ */
+inline size_t page_size(){
+#if defined(__unix__) || defined(__APPLE__)
+	const long p = sysconf(_SC_PAGESIZE);
+	if(p > 0)
+		return (size_t)p;
+#endif
+	return 4096;
+}
+
+} // namespace xoshiro_detail
+
+/*
+ * number of values per scheduling block. this only affects load balancing,
+ * never the values written. an enumerator rather than a const variable, which
+ * would have internal linkage and couldn't be used by parallel_fill once it is
+ * exported from the module.
+ */
+enum parallel_fill_constants : size_t { PARALLEL_FILL_BLOCK = 1 << 16 };
+
+/*
+ * seeds an engine from a 64-bit seed in the same way the default constructor
+ * seeds from the time, one splitmix64 output per state word, and starts a ring
+ * state at 0, whatever the engine had drawn before
+ */
+template <class Engine>
+void seed_engine(Engine &e, uint64_t seed){
+	typename Engine::word w[Engine::family::words];
+	xoshiro_detail::seed_words(seed, w, Engine::family::words);
+	e.set_state(w);
+}
+
+/*
+ * fills out[0..n) with the first n outputs of an Engine seeded from seed,
+ * using up to threads threads (0 means one per hardware thread)
+ */
+template <class Engine = xoshiro256ss>
+void parallel_fill(uint64_t *out, size_t n, uint64_t seed, unsigned threads = 0){
+	typename Engine::word w[Engine::family::words];
+	xoshiro_detail::seed_words(seed, w, Engine::family::words);
+	const Engine base(w);
+	const size_t blocks = (n + PARALLEL_FILL_BLOCK - 1) / PARALLEL_FILL_BLOCK;
+	if(threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if(threads == 0)
+		threads = 1;
+	if(threads > blocks)
+		threads = blocks ? blocks : 1;
+
+	std::atomic<size_t> next(0);
+	auto worker = [&](){
+		Engine e = base; // positioned at output index pos
+		size_t pos = 0;
+		for(size_t b = next++; b < blocks; b = next++){
+			const size_t start = b * PARALLEL_FILL_BLOCK;
+			const size_t end = start + PARALLEL_FILL_BLOCK < n ? start + PARALLEL_FILL_BLOCK : n;
+			// blocks are claimed in increasing order, so we only ever move forward
+			e.advance(start - pos);
+			for(size_t i = start; i < end; i++)
+				out[i] = e.Engine::operator()(); // qualified call skips the vtable
+			pos = end;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	try {
+		for(unsigned t = 1; t < threads; t++)
+			pool.emplace_back(worker);
+	} catch(...) {
+		// could not start every thread, the ones we have will still cover all blocks
+	}
+	worker();
+	for(auto &t : pool)
+		t.join();
+}
+
+/*
+ * class declaration for padded per-thread engines. engine i is base after i
+ * jumps. slots are constructed by the first access, so if thread i is the first
+ * to touch slot i, first-touch NUMA policy puts it on thread i's node. that only
+ * works at page granularity, which is what page_per_slot is for. each slot
+ * holds its engine and the flag saying whether it has been constructed, so a
+ * thread only ever touches its own line.
+ */
+template <class Engine = xoshiro256ss>
+class per_thread_engines {
+public:
+	per_thread_engines(unsigned threads, const Engine &base, bool page_per_slot = false);
+	per_thread_engines(const per_thread_engines&) = delete;
+	per_thread_engines& operator=(const per_thread_engines&) = delete;
+	~per_thread_engines();
+	Engine& operator[](unsigned i); // thread i's engine
+	unsigned size() const; // number of slots
+	size_t stride() const; // bytes between two slots
+private:
+	Engine* at(unsigned i); // address of slot i
+	char& ready(unsigned i); // whether slot i has been constructed, just past its engine
+	unsigned n_; // number of slots
+	size_t stride_; // engine and flag rounded up to a cache line or a page
+	Engine base_; // engine of slot 0
+	char *raw_; // the allocation
+	char *mem_; // raw_ aligned to the stride
+};
+
+/*
+ * allocates the slots without touching them. the flags have to read as 0
+ * before anything is written, and calloc gets large blocks as fresh zero pages
+ * from the system without writing to them, where zeroing the memory here
+ * would place every page on this thread's node.
+ */
+template <class Engine>
+per_thread_engines<Engine>::per_thread_engines(unsigned threads, const Engine &base, bool page_per_slot)
+	: n_(threads), base_(base) {
+	const size_t align = page_per_slot ? xoshiro_detail::page_size() : XOSHIRO_CACHE_LINE;
+	stride_ = (sizeof(Engine) + 1 + align - 1) / align * align;
+	raw_ = static_cast<char*>(std::calloc(n_ * stride_ + align, 1));
+	if(!raw_)
+		throw std::bad_alloc();
+	mem_ = raw_ + (align - reinterpret_cast<uintptr_t>(raw_) % align) % align;
+}
+
+/*
+ * destroys the engines that were constructed
+ */
+template <class Engine>
+per_thread_engines<Engine>::~per_thread_engines(){
+	for(unsigned i = 0; i < n_; i++)
+		if(ready(i))
+			at(i)->~Engine();
+	std::free(raw_);
+}
+
+/*
+ * address of slot i
+ */
+template <class Engine>
+Engine* per_thread_engines<Engine>::at(unsigned i){
+	return reinterpret_cast<Engine*>(mem_ + i * stride_);
+}
+
+/*
+ * the flag of slot i
+ */
+template <class Engine>
+char& per_thread_engines<Engine>::ready(unsigned i){
+	return mem_[i * stride_ + sizeof(Engine)];
+}
+
+/*
+ * thread i's engine, constructing it on first use. only thread i may call this
+ * with i.
+ */
+template <class Engine>
+Engine& per_thread_engines<Engine>::operator[](unsigned i){
+	if(!ready(i)){
+		Engine *e = new(at(i)) Engine(base_);
+		e->jump(i);
+		ready(i) = 1;
+	}
+	return *at(i);
+}
+
+/*
+ * number of slots
+ */
+template <class Engine>
+unsigned per_thread_engines<Engine>::size() const{
+	return n_;
+}
+
+/*
+ * bytes between two slots
+ */
+template <class Engine>
+size_t per_thread_engines<Engine>::stride() const{
+	return stride_;
+}
+
+#endif /* XOSHIRO256_PARALLEL_HPP_ */
@@ -0,0 +1,246 @@
+/*
+ * xoshiro256_pool.hpp
+ *
+ *  A pool of jump-separated engines that tasks check out and give back. This is
+ *  for runtimes that move tasks between threads (coroutines, fibers, work
+ *  stealing), where a thread_local engine would be shared by every task that
+ *  happens to run on that thread and the values a task sees would depend on
+ *  scheduling.
+ *
+ *  Free engines sit on lock-free stacks: one per core, plus a global overflow
+ *  stack that the per-core stacks spill to and refill from. A core that finds
+ *  both empty takes from the other cores' stacks, so a checkout only fails when
+ *  every engine is out. A checkout is one compare-and-swap in the common case. checkout(task_id) additionally puts the
+ *  engine at a position that only depends on the task id, so a task gets the same
+ *  values whichever engine, thread or core it ends up with.
+ */
+#ifndef XOSHIRO256_POOL_HPP_
+#define XOSHIRO256_POOL_HPP_
+
+#include "xoshiro256_parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/*
+ * class declaration for the engine pool. engine i starts as base after i jumps.
+ * the streams handed out by task id are base after one long jump and task_id
+ * jumps, so they never overlap the pool's own streams. slots and stacks are
+ * cache-line aligned when std::vector honours over-alignment (C++17).
+ */
+template <class Engine = xoshiro256ss>
+class engine_pool {
+public:
+	class lease; // a checked out engine, returned to the pool when destroyed
+	engine_pool(uint32_t capacity, const Engine &base, unsigned shards = 0);
+	engine_pool(const engine_pool&) = delete;
+	engine_pool& operator=(const engine_pool&) = delete;
+	lease checkout(); // any free engine, or an empty lease if all are out
+	lease checkout(uint64_t task_id); // a free engine positioned at task_id's stream
+	uint32_t capacity() const; // number of engines
+private:
+	static const uint32_t NIL = 0xffffffff; // end of a free list
+	static const int SPILL = 64; // a core keeps at most this many free engines
+	static const int REFILL = SPILL / 4; // engines a core takes from the global stack at once
+	struct alignas(XOSHIRO_CACHE_LINE) slot {
+		Engine e; // the engine
+		std::atomic<uint32_t> next; // next free slot on the same stack
+	};
+	struct alignas(XOSHIRO_CACHE_LINE) stack {
+		std::atomic<uint64_t> head; // index of the top slot, plus a tag in the high half against ABA
+		std::atomic<int> count; // approximate number of entries
+	};
+	uint32_t pop(stack &st); // NIL if empty
+	void push(stack &st, uint32_t i);
+	stack& local(); // the calling core's stack
+	uint32_t refill(stack &st); // one engine from the global stack for st's core, more go onto st
+	uint32_t steal(const stack &st); // one engine from any core's stack but st
+	void give_back(uint32_t i); // return slot i to the pool
+	std::vector<slot> slots_; // the engines
+	std::vector<stack> stacks_; // per-core stacks; the last one is the global overflow
+	Engine task_base_; // start of the task id streams
+};
+
+/*
+ * class declaration for a checked out engine. it is move-only and can be held
+ * across suspensions and resumed on another thread.
+ */
+template <class Engine>
+class engine_pool<Engine>::lease {
+public:
+	lease() : pool_(nullptr), i_(NIL) {}
+	lease(lease &&o) : pool_(o.pool_), i_(o.i_) { o.pool_ = nullptr; }
+	lease& operator=(lease &&o){ reset(); pool_ = o.pool_; i_ = o.i_; o.pool_ = nullptr; return *this; }
+	~lease(){ reset(); }
+	explicit operator bool() const { return pool_ != nullptr; } // false if the pool was exhausted
+	Engine& operator*() const { return pool_->slots_[i_].e; }
+	Engine* operator->() const { return &pool_->slots_[i_].e; }
+	void reset(){ if(pool_) pool_->give_back(i_); pool_ = nullptr; } // return the engine early
+private:
+	friend class engine_pool;
+	lease(engine_pool *pool, uint32_t i) : pool_(pool), i_(i) {}
+	engine_pool *pool_; // owning pool, null when empty
+	uint32_t i_; // slot index
+};
+
+/*
+ * builds the engines and puts them all on the global stack. shards defaults to
+ * the number of hardware threads.
+ */
+template <class Engine>
+engine_pool<Engine>::engine_pool(uint32_t capacity, const Engine &base, unsigned shards)
+	: slots_(capacity), stacks_((shards ? shards : std::max(1u, std::thread::hardware_concurrency())) + 1),
+	  task_base_(base) {
+	Engine e(base);
+	for(uint32_t i = 0; i < capacity; i++){
+		slots_[i].e = e;
+		e.jump();
+	}
+	task_base_.long_jump();
+	for(auto &st : stacks_){
+		st.head.store(NIL);
+		st.count.store(0);
+	}
+	for(uint32_t i = capacity; i-- > 0;)
+		push(stacks_.back(), i);
+}
+
+/*
+ * Treiber stack pop. the tag is bumped on every change of the head, so a slot
+ * that was popped and pushed back in between is not mistaken for the old head.
+ */
+template <class Engine>
+uint32_t engine_pool<Engine>::pop(stack &st){
+	uint64_t head = st.head.load(std::memory_order_acquire);
+	for(;;){
+		const uint32_t i = uint32_t(head);
+		if(i == NIL)
+			return NIL;
+		const uint64_t next = (head >> 32 << 32) + (UINT64_C(1) << 32) + slots_[i].next.load(std::memory_order_relaxed);
+		if(st.head.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)){
+			st.count.fetch_sub(1, std::memory_order_relaxed);
+			return i;
+		}
+	}
+}
+
+/*
+ * Treiber stack push
+ */
+template <class Engine>
+void engine_pool<Engine>::push(stack &st, uint32_t i){
+	uint64_t head = st.head.load(std::memory_order_relaxed);
+	for(;;){
+		slots_[i].next.store(uint32_t(head), std::memory_order_relaxed);
+		const uint64_t next = (head >> 32 << 32) + (UINT64_C(1) << 32) + i;
+		if(st.head.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed))
+			break;
+	}
+	st.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+ * picks the stack of the core we are running on. where that is not available
+ * the thread id is used, which still spreads threads over the stacks.
+ */
+template <class Engine>
+typename engine_pool<Engine>::stack& engine_pool<Engine>::local(){
+	const size_t shards = stacks_.size() - 1;
+#ifdef __linux__
+	const int cpu = sched_getcpu();
+	if(cpu >= 0)
+		return stacks_[size_t(cpu) % shards];
+#endif
+	return stacks_[std::hash<std::thread::id>()(std::this_thread::get_id()) % shards];
+}
+
+/*
+ * takes a batch from the global stack, so the next checkouts on this core find
+ * their engines locally
+ */
+template <class Engine>
+uint32_t engine_pool<Engine>::refill(stack &st){
+	const uint32_t i = pop(stacks_.back());
+	for(int k = 1; i != NIL && k < REFILL; k++){
+		const uint32_t j = pop(stacks_.back());
+		if(j == NIL)
+			break;
+		push(st, j);
+	}
+	return i;
+}
+
+/*
+ * the other cores' stacks in turn, starting after st. engines given back on a
+ * core stay there up to SPILL of them, and another core may need them.
+ */
+template <class Engine>
+uint32_t engine_pool<Engine>::steal(const stack &st){
+	const size_t shards = stacks_.size() - 1, own = &st - stacks_.data();
+	for(size_t k = 1; k < shards; k++){
+		const uint32_t i = pop(stacks_[(own + k) % shards]);
+		if(i != NIL)
+			return i;
+	}
+	return NIL;
+}
+
+/*
+ * local stack first, then the global one, then the other cores. an engine can
+ * be missed while a refill moves it between stacks, so under contention an
+ * empty lease may come back with an engine or two still free.
+ */
+template <class Engine>
+typename engine_pool<Engine>::lease engine_pool<Engine>::checkout(){
+	stack &st = local();
+	uint32_t i = pop(st);
+	if(i == NIL)
+		i = refill(st);
+	if(i == NIL)
+		i = steal(st);
+	if(i == NIL)
+		return lease();
+	return lease(this, i);
+}
+
+/*
+ * same as checkout(), then moves the engine to the task's stream. this costs a
+ * jump(n), a few microseconds whatever the id.
+ */
+template <class Engine>
+typename engine_pool<Engine>::lease engine_pool<Engine>::checkout(uint64_t task_id){
+	lease l = checkout();
+	if(l){
+		*l = task_base_;
+		l->jump(task_id);
+	}
+	return l;
+}
+
+/*
+ * returned engines stay on the local stack unless it is already well stocked
+ */
+template <class Engine>
+void engine_pool<Engine>::give_back(uint32_t i){
+	stack &st = local();
+	if(st.count.load(std::memory_order_relaxed) < SPILL)
+		push(st, i);
+	else
+		push(stacks_.back(), i);
+}
+
+/*
+ * number of engines
+ */
+template <class Engine>
+uint32_t engine_pool<Engine>::capacity() const{
+	return slots_.size();
+}
+
+#endif /* XOSHIRO256_POOL_HPP_ */
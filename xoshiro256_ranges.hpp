@@ -0,0 +1,219 @@
+/*
+ * xoshiro256_ranges.hpp
+ *
+ *  C++20 range views over the engines, so random values can go straight into
+ *  range pipelines:
+ *
+ *      xoshiro256ss e(1, 2, 3, 4);
+ *      for(double x : xoshiro::views::uniform(e, 0.0, 1.0)
+ *                   | std::views::transform(f)
+ *                   | std::views::take(n))
+ *          ...
+ *
+ *  The views are infinite input ranges. They draw from the engine BLOCK values at
+ *  a time into a buffer inside the view, so the inner loop is a plain non-virtual
+ *  call instead of one virtual operator() per element. The flip side is that the
+ *  engine moves on by whole blocks: once a pipeline is done the engine can be up
+ *  to BLOCK-1 values further along than what was consumed.
+ *
+ *  uniform(), exponential() and geometric() give exactly the values the member
+ *  functions of the same name would give from the same engine, in its real type
+ *  (float for the 32-bit engines), see xoshiro_detail::uniform_conversion.
+ */
+#ifndef XOSHIRO256_RANGES_HPP_
+#define XOSHIRO256_RANGES_HPP_
+
+#include "xoshiro256_core.hpp"
+#if __cplusplus >= 202002L
+#include <version>
+#endif
+#if defined(__cpp_lib_ranges)
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <typeinfo>
+
+namespace xoshiro {
+
+/*
+ * class declaration for a view of converted engine output. Conv takes a raw
+ * value of the engine's word type and either writes a converted value and
+ * returns true, or rejects it and returns false.
+ */
+template <class Engine, class Conv>
+class generator_view : public std::ranges::view_interface<generator_view<Engine, Conv> > {
+public:
+	static constexpr size_t BLOCK = 64; // raw values drawn per refill
+	using value_type = typename Conv::value_type;
+	class iterator;
+	generator_view(Engine &e, Conv conv) : e_(&e), conv_(conv), pos_(0), count_(0) {}
+	iterator begin(); // starts at the next buffered value
+	std::default_sentinel_t end() const { return std::default_sentinel; } // never reached
+private:
+	void refill(); // draws blocks until at least one value is accepted
+	Engine *e_; // the engine, not owned
+	Conv conv_; // raw value to value_type
+	size_t pos_, count_; // next and end of the buffered values
+	value_type buf_[BLOCK]; // converted values
+};
+
+/*
+ * class declaration for the view's iterator
+ */
+template <class Engine, class Conv>
+class generator_view<Engine, Conv>::iterator {
+public:
+	using value_type = typename Conv::value_type;
+	using difference_type = std::ptrdiff_t;
+	using iterator_concept = std::input_iterator_tag;
+	iterator() = default;
+	explicit iterator(generator_view *v) : v_(v) {}
+	const value_type& operator*() const { return v_->buf_[v_->pos_]; }
+	iterator& operator++(){ if(++v_->pos_ == v_->count_) v_->refill(); return *this; }
+	void operator++(int){ ++*this; }
+	friend bool operator==(const iterator&, std::default_sentinel_t) { return false; }
+private:
+	generator_view *v_ = nullptr; // the view holding the buffer
+};
+
+/*
+ * the buffer lives in the view, so there is one position per view
+ */
+template <class Engine, class Conv>
+typename generator_view<Engine, Conv>::iterator generator_view<Engine, Conv>::begin(){
+	if(pos_ == count_)
+		refill();
+	return iterator(this);
+}
+
+/*
+ * draws a block with the engine's own operator() called non-virtually. if the
+ * engine is really a subclass (an xoshiro256p behind an xoshiro256ss&) the
+ * virtual call is kept, so the values are always the right ones.
+ */
+template <class Engine, class Conv>
+void generator_view<Engine, Conv>::refill(){
+	typename Engine::word raw[BLOCK];
+	do {
+		if constexpr (std::is_polymorphic_v<Engine>){
+			if(typeid(*e_) == typeid(Engine))
+				for(size_t i = 0; i < BLOCK; i++)
+					raw[i] = e_->Engine::operator()();
+			else
+				for(size_t i = 0; i < BLOCK; i++)
+					raw[i] = (*e_)();
+		} else {
+			for(size_t i = 0; i < BLOCK; i++)
+				raw[i] = (*e_)();
+		}
+		count_ = 0;
+		for(size_t i = 0; i < BLOCK; i++)
+			count_ += conv_(raw[i], buf_[count_]);
+	} while(count_ == 0);
+	pos_ = 0;
+}
+
+namespace conversions {
+
+/*
+ * raw engine output
+ */
+template <class Word>
+struct raw {
+	using value_type = Word;
+	bool operator()(Word n, Word &out) const { out = n; return true; }
+};
+
+/*
+ * same as the engines' uniform(): the values uniform_conversion rejects are
+ * skipped, the others converted by it
+ */
+template <class Word>
+struct uniform {
+	using conversion = xoshiro_detail::uniform_conversion<Word>;
+	using value_type = typename conversion::real;
+	value_type low, high;
+	bool operator()(Word n, value_type &out) const {
+		if(conversion::rejected(n))
+			return false;
+		out = conversion::convert(n, low, high);
+		return true;
+	}
+};
+
+/*
+ * same as the engines' exponential()
+ */
+template <class Word>
+struct exponential {
+	using value_type = typename uniform<Word>::value_type;
+	value_type mean;
+	bool operator()(Word n, value_type &out) const {
+		value_type r;
+		if(!uniform<Word>{0, 1}(n, r))
+			return false;
+		out = -mean*std::log(1-r);
+		return true;
+	}
+};
+
+/*
+ * same as the engines' geometric()
+ */
+template <class Word>
+struct geometric {
+	using value_type = int;
+	typename uniform<Word>::value_type success;
+	bool operator()(Word n, int &out) const {
+		typename uniform<Word>::value_type r;
+		if(!uniform<Word>{0, 1}(n, r))
+			return false;
+		out = std::ceil(-1+(std::log(1-r)/std::log(1-success)));
+		return true;
+	}
+};
+
+} // namespace conversions
+
+namespace views {
+
+/*
+ * raw engine output
+ */
+template <class Engine>
+generator_view<Engine, conversions::raw<typename Engine::word> > random(Engine &e){
+	return generator_view<Engine, conversions::raw<typename Engine::word> >(e, {});
+}
+
+/*
+ * uniform reals in (low, high)
+ */
+template <class Engine>
+generator_view<Engine, conversions::uniform<typename Engine::word> > uniform(Engine &e,
+		typename Engine::real low, typename Engine::real high){
+	return generator_view<Engine, conversions::uniform<typename Engine::word> >(e, {low, high});
+}
+
+/*
+ * exponential reals with the given mean
+ */
+template <class Engine>
+generator_view<Engine, conversions::exponential<typename Engine::word> > exponential(Engine &e, typename Engine::real mean){
+	return generator_view<Engine, conversions::exponential<typename Engine::word> >(e, {mean});
+}
+
+/*
+ * geometric ints, P(i failures) = p(1-p)^i
+ */
+template <class Engine>
+generator_view<Engine, conversions::geometric<typename Engine::word> > geometric(Engine &e, typename Engine::real success){
+	return generator_view<Engine, conversions::geometric<typename Engine::word> >(e, {success});
+}
+
+} // namespace views
+} // namespace xoshiro
+
+#endif /* C++20 ranges */
+#endif /* XOSHIRO256_RANGES_HPP_ */
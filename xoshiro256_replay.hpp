@@ -0,0 +1,285 @@
+/*
+ * xoshiro256_replay.hpp
+ *
+ *  Record and replay of an engine's stream without storing the draws. A
+ *  replay_log keeps the engine's state every 2^k draws (a checkpoint), and
+ *  rebuilds the state at any position from the nearest checkpoint with
+ *  advance(), which costs O(log n) steps instead of regenerating the n draws.
+ *  With k = 16 a checkpoint of xoshiro256 is 82 bytes per 65536 draws. A log
+ *  takes any engine, as long as all its checkpoints are of one state size.
+ *
+ *  Compile everything with -DXOSHIRO_REPLAY to have the engines keep count:
+ *  every engine then knows its position() (draws since seeding), and once
+ *  record() is called it checkpoints itself into the log.
+ *
+ *      replay_log log(16);
+ *      entity.rng.record(&log);
+ *      ...                                  // the simulation runs
+ *      std::vector<char> text(log.dump_size());
+ *      log.dump(text.data(), text.size());  // kept with the results
+ *
+ *      replay_log log;
+ *      log.parse(text, size);
+ *      xoshiro256ss e = log.engine_at<xoshiro256ss>(1234567);
+ *      e();                                 // draw number 1234568 again
+ *
+ *  The macro adds 24 bytes to the engines and a compare and branch to every
+ *  draw, which is why it is opt-in; it changes the layout of the classes, so
+ *  every translation unit must agree on it. Without it the log still works,
+ *  but the checkpoints have to be given to it by hand with checkpoint().
+ *
+ *  Jumps move the engine to another stream without changing its position, so
+ *  they are checkpointed at once and replays past them start from there.
+ *  Assigning to a recorded engine or writing its state directly isn't seen by
+ *  the log; call record() again afterwards. A copy of a recorded engine keeps
+ *  the position but isn't recorded.
+ *
+ *  The text form is a header line "xoshiro-replay k=NN" and then one line per
+ *  checkpoint: the position in 16 hex digits, a space, and the state in the
+ *  hex digits of xoshiro_io::to_hex (64 for xoshiro256, 16 per 64 bits of
+ *  state in general).
+ */
+#ifndef XOSHIRO256_REPLAY_HPP_
+#define XOSHIRO256_REPLAY_HPP_
+
+#include "xoshiro256_core.hpp"
+#include "xoshiro256_io.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * class declaration for the checkpoint log of one engine
+ */
+class replay_log {
+public:
+	explicit replay_log(unsigned k = 16); // a checkpoint every 2^k draws, k < 64
+	unsigned interval_bits() const; // k
+	size_t size() const; // number of checkpoints
+	template <class Engine>
+	void checkpoint(uint64_t position, const Engine &e); // e's state after position draws, replaces later checkpoints
+	template <class Engine = xoshiro256ss>
+	void state_at(uint64_t position, typename Engine::word *s) const; // the words after position draws, as get_state() gives them
+	template <class Engine>
+	Engine engine_at(uint64_t position) const; // an engine in that state, whose next draw is draw position+1
+	size_t dump_size() const; // bytes dump() writes
+	size_t dump(char *out, size_t size) const; // the text form, returns the bytes written or 0 if size is too small
+	bool parse(const char *in, size_t size); // replaces the log with a dump, false if the text isn't one
+private:
+	void add(uint64_t position, const uint64_t *state, unsigned width); // checkpoint() once the state is in 64-bit pieces
+	const uint64_t* nearest(uint64_t position, unsigned width, uint64_t &from) const; // the checkpoint to start from and its position
+	static const size_t HEADER_CHARS = 20; // "xoshiro-replay k=NN\n"
+	unsigned k_; // log2 of the checkpoint interval
+	unsigned width_; // 64-bit pieces per state, as xoshiro_detail::to_chunks() makes them
+	std::vector<uint64_t> positions_; // draws before each state, increasing
+	std::vector<uint64_t> states_; // the states, width_ pieces each
+};
+
+/*
+ * the state goes in as the 64-bit pieces of its text form, so the log holds
+ * the states of every family the same way
+ */
+template <class Engine>
+void replay_log::checkpoint(uint64_t position, const Engine &e){
+	typedef typename Engine::family family;
+	typename family::word w[family::words];
+	uint64_t c[xoshiro_detail::field_words<family>()];
+	e.get_state(w);
+	xoshiro_detail::to_chunks(w, family::words, c);
+	add(position, c, xoshiro_detail::field_words<family>());
+}
+
+/*
+ * forward from the last checkpoint at or before the position. a position
+ * before the first checkpoint is reached backwards from it with retreat().
+ * throws std::out_of_range if the log is empty, std::invalid_argument if its
+ * states aren't the size of Engine's.
+ */
+template <class Engine>
+void replay_log::state_at(uint64_t position, typename Engine::word *s) const{
+	typedef typename Engine::family family;
+	uint64_t from;
+	const uint64_t *c = nearest(position, xoshiro_detail::field_words<family>(), from);
+	typename family::word w[family::words];
+	xoshiro_detail::from_chunks(c, family::words, w);
+	xoshiro_engine<family> e(w);
+	if(position < from)
+		e.retreat(from - position);
+	else
+		e.advance(position - from);
+	e.get_state(s);
+}
+
+/*
+ * with XOSHIRO_REPLAY the engine also gets its position back, so it can go on
+ * recording into another log
+ */
+template <class Engine>
+Engine replay_log::engine_at(uint64_t position) const{
+	typename Engine::word s[Engine::family::words];
+	state_at<Engine>(position, s);
+	Engine e(s);
+#ifdef XOSHIRO_REPLAY
+	e.replay_.position = position;
+#endif
+	return e;
+}
+
+#ifdef XOSHIRO_REPLAY
+namespace xoshiro_detail {
+
+/*
+ * called by the engines when a checkpoint is due. the next one is due at the
+ * next multiple of 2^k.
+ */
+template <class Engine>
+void checkpoint(Engine *e){
+	replay_cursor &c = e->replay_;
+	if(!c.log){
+		c.next = UINT64_MAX;
+		return;
+	}
+	c.log->checkpoint(c.position, *e);
+	const unsigned k = c.log->interval_bits();
+	const uint64_t block = c.position >> k;
+	c.next = block < (UINT64_MAX >> k) ? (block + 1) << k : UINT64_MAX;
+}
+
+} // namespace xoshiro_detail
+#endif
+
+#if XOSHIRO256_IMPL
+
+XOSHIRO256_DECL replay_log::replay_log(unsigned k) : k_(k < 63 ? k : 63), width_(0) {}
+
+XOSHIRO256_DECL unsigned replay_log::interval_bits() const{
+	return k_;
+}
+
+XOSHIRO256_DECL size_t replay_log::size() const{
+	return positions_.size();
+}
+
+/*
+ * the engine only ever moves forward past its last checkpoint between two
+ * calls, unless it went back and then jumped to another stream; the
+ * checkpoints after the new one describe the old stream then and are dropped
+ */
+XOSHIRO256_DECL void replay_log::add(uint64_t position, const uint64_t *state, unsigned width){
+	if(!positions_.empty() && width != width_)
+		throw std::invalid_argument("replay_log: a state of another size");
+	while(!positions_.empty() && positions_.back() >= position){
+		positions_.pop_back();
+		states_.resize(states_.size() - width_);
+	}
+	width_ = width;
+	positions_.push_back(position);
+	states_.insert(states_.end(), state, state + width);
+}
+
+XOSHIRO256_DECL const uint64_t* replay_log::nearest(uint64_t position, unsigned width, uint64_t &from) const{
+	if(positions_.empty())
+		throw std::out_of_range("replay_log: no checkpoints");
+	if(width != width_)
+		throw std::invalid_argument("replay_log: the states are of another size");
+	size_t i = std::upper_bound(positions_.begin(), positions_.end(), position) - positions_.begin();
+	if(i)
+		i--;
+	from = positions_[i];
+	return &states_[i * width_];
+}
+
+XOSHIRO256_DECL size_t replay_log::dump_size() const{
+	return HEADER_CHARS + positions_.size() * (16 + 1 + 16*width_ + 1);
+}
+
+XOSHIRO256_DECL size_t replay_log::dump(char *out, size_t size) const{
+	if(size < dump_size())
+		return 0;
+	char *p = out, *end = out + size;
+	memcpy(p, "xoshiro-replay k=", 17);
+	p[17] = '0' + k_ / 10;
+	p[18] = '0' + k_ % 10;
+	p[19] = '\n';
+	p += HEADER_CHARS;
+	for(size_t i = 0; i < positions_.size(); i++){
+		p = xoshiro_io::to_hex(p, end, positions_[i]);
+		*p++ = ' ';
+		for(unsigned j = 0; j < width_; j++)
+			p = xoshiro_io::to_hex(p, end, states_[i * width_ + j]);
+		*p++ = '\n';
+	}
+	return p - out;
+}
+
+/*
+ * the positions must increase, every state must have the length of the first
+ * one, and no state may be all zeros. a line may end in "\r\n", and the last
+ * one needs no newline.
+ */
+XOSHIRO256_DECL bool replay_log::parse(const char *in, size_t size){
+	const char *p = in, *end = in + size;
+	if(size < HEADER_CHARS - 1 || memcmp(p, "xoshiro-replay k=", 17) || (unsigned)(p[17] - '0') > 9
+			|| (unsigned)(p[18] - '0') > 9)
+		return false;
+	const unsigned k = (p[17] - '0') * 10 + (p[18] - '0');
+	if(k > 63)
+		return false;
+	p += 19;
+	std::vector<uint64_t> positions, states;
+	unsigned width = 0;
+	for(;;){
+		// the end of the previous line
+		if(p < end && *p == '\r')
+			p++;
+		if(p == end)
+			break;
+		if(*p++ != '\n')
+			return false;
+		if(p == end)
+			break;
+		uint64_t position;
+		p = xoshiro_io::from_hex(p, end, position);
+		if(!p || p == end || *p++ != ' ')
+			return false;
+		unsigned n = 0;
+		uint64_t any = 0;
+		while(p < end && *p != '\r' && *p != '\n'){
+			uint64_t c;
+			if(!(p = xoshiro_io::from_hex(p, end, c)))
+				return false;
+			states.push_back(c);
+			any |= c;
+			n++;
+		}
+		if(any == 0 || (width && n != width) || (!positions.empty() && positions.back() >= position))
+			return false;
+		width = n;
+		positions.push_back(position);
+	}
+	k_ = k;
+	width_ = width;
+	positions_.swap(positions);
+	states_.swap(states);
+	return true;
+}
+
+#ifdef XOSHIRO_REPLAY
+template <class Family>
+XOSHIRO256_DECL uint64_t xoshiro_engine<Family>::position() const{
+	return this->replay_.position;
+}
+
+/*
+ * the current state is the first checkpoint
+ */
+template <class Family>
+XOSHIRO256_DECL void xoshiro_engine<Family>::record(replay_log *log){
+	this->replay_.log = log;
+	xoshiro_detail::checkpoint(this);
+}
+#endif
+
+#endif /* XOSHIRO256_IMPL */
+
+#endif /* XOSHIRO256_REPLAY_HPP_ */
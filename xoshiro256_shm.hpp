@@ -0,0 +1,279 @@
+/*
+ * xoshiro256_shm.hpp
+ *
+ *  Hands out non-overlapping streams to cooperating processes (POSIX only).
+ *
+ *  A basic_stream_registry maps a small file shared by every process that opens
+ *  the same path. The file holds one atomic counter; each process that needs a
+ *  stream takes the next value k from it and uses the base engine after k long
+ *  jumps, so no two processes ever share a stream, whatever order they start in.
+ *  stream_registry is the one for xoshiro256**; any engine of any family works.
+ *
+ *  This is mostly for prefork servers: an engine created before fork() is copied
+ *  into every child, so all the workers would produce the same values. Engines
+ *  registered with attach() are moved to a fresh slot in the child right after
+ *  fork() by a pthread_atfork handler.
+ */
+#ifndef XOSHIRO256_SHM_HPP_
+#define XOSHIRO256_SHM_HPP_
+
+#include "xoshiro256_core.hpp"
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace xoshiro_detail {
+
+/*
+ * class declaration for the process-wide list of engines that every registry
+ * moves to a slot of its own in the child after fork(). the entries are type
+ * erased, so one set of pthread_atfork handlers serves every engine type.
+ */
+class fork_hooks {
+public:
+	typedef void (*hook)(void *owner, void *target); // repositions target for owner, in the child
+	static void add(void *owner, void *target, hook f); // installs the fork handlers on first use
+	static void remove(void *owner, void *target); // a null target removes all of owner's entries
+private:
+	struct entry {
+		void *owner; // the registry
+		void *target; // the engine
+		hook f; // owner's reposition
+	};
+	static std::mutex& lock(); // guards entries()
+	static std::vector<entry>& entries(); // engines to move after fork
+	static void before_fork();
+	static void after_fork_parent();
+	static void after_fork_child();
+};
+
+} // namespace xoshiro_detail
+
+/*
+ * class declaration for the registry. every process must use the same seed for
+ * the same file, the file only stores the slot counter.
+ */
+template <class Engine>
+class basic_stream_registry {
+public:
+	basic_stream_registry(const char *path, uint64_t seed); // opens or creates the file
+	basic_stream_registry(const basic_stream_registry&) = delete;
+	basic_stream_registry& operator=(const basic_stream_registry&) = delete;
+	~basic_stream_registry(); // detaches this registry's engines and unmaps the file
+	uint64_t acquire(); // claims the next slot, unique across all processes
+	Engine engine(); // an engine on a freshly claimed slot
+	void position(Engine &e); // moves e to a freshly claimed slot
+	void attach(Engine &e); // repositions e in the child after every fork()
+	void detach(Engine &e); // stops doing that
+private:
+	struct segment {
+		std::atomic<uint64_t> next; // next free slot. the file starts zero-filled
+	};
+	static Engine seeded(uint64_t seed); // slot 0, seeded like seed_engine() does
+	static void reposition(void *owner, void *target); // the fork_hooks entry for an attached engine
+	Engine base_; // slot 0
+	segment *seg_; // the mapped counter
+	int fd_; // the backing file
+};
+
+typedef basic_stream_registry<xoshiro256ss> stream_registry; // xoshiro256** streams
+
+/*
+ * maps the file, creating and sizing it if needed. the counter needs atomics
+ * that work across processes, which lock-free ones do. the descriptor is closed
+ * on exec, a program started by a worker has no use for it.
+ */
+template <class Engine>
+basic_stream_registry<Engine>::basic_stream_registry(const char *path, uint64_t seed)
+	: base_(seeded(seed)) {
+	static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the slot counter must be lock-free to live in shared memory");
+	fd_ = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if(fd_ < 0)
+		throw std::system_error(errno, std::generic_category(), "stream_registry: open");
+	if(ftruncate(fd_, sizeof(segment)) != 0){
+		const int err = errno;
+		close(fd_);
+		throw std::system_error(err, std::generic_category(), "stream_registry: ftruncate");
+	}
+	void *p = mmap(nullptr, sizeof(segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+	if(p == MAP_FAILED){
+		const int err = errno;
+		close(fd_);
+		throw std::system_error(err, std::generic_category(), "stream_registry: mmap");
+	}
+	seg_ = static_cast<segment*>(p);
+	// long_jump(k) raises the jump polynomial to the k-th power in the engine's
+	// field, a function-local static built on the first call. the child handler
+	// must not be the one to build it: that takes a guard another thread of the
+	// parent may have held at fork(), and the child would wait on it forever
+	Engine::field();
+}
+
+/*
+ * unmaps the file. the file itself is left for the other processes.
+ */
+template <class Engine>
+basic_stream_registry<Engine>::~basic_stream_registry(){
+	xoshiro_detail::fork_hooks::remove(this, nullptr);
+	munmap(seg_, sizeof(segment));
+	close(fd_);
+}
+
+/*
+ * one atomic increment on the shared counter
+ */
+template <class Engine>
+uint64_t basic_stream_registry<Engine>::acquire(){
+	return seg_->next.fetch_add(1);
+}
+
+/*
+ * engine on a new slot
+ */
+template <class Engine>
+Engine basic_stream_registry<Engine>::engine(){
+	Engine e(base_);
+	position(e);
+	return e;
+}
+
+/*
+ * slot k is base_ after k long jumps, 2^(3*bits/4) values apart for a state of
+ * that many bits
+ */
+template <class Engine>
+void basic_stream_registry<Engine>::position(Engine &e){
+	const uint64_t k = acquire();
+	typename Engine::word w[Engine::family::words];
+	base_.get_state(w);
+	e.set_state(w);
+	e.long_jump(k);
+}
+
+/*
+ * the engine must outlive the attachment, or be detached first
+ */
+template <class Engine>
+void basic_stream_registry<Engine>::attach(Engine &e){
+	xoshiro_detail::fork_hooks::add(this, &e, &basic_stream_registry::reposition);
+}
+
+/*
+ * forget about e
+ */
+template <class Engine>
+void basic_stream_registry<Engine>::detach(Engine &e){
+	xoshiro_detail::fork_hooks::remove(this, &e);
+}
+
+/*
+ * one splitmix64 output per word, see xoshiro_detail::seed_words()
+ */
+template <class Engine>
+Engine basic_stream_registry<Engine>::seeded(uint64_t seed){
+	typename Engine::word w[Engine::family::words];
+	xoshiro_detail::seed_words(seed, w, Engine::family::words);
+	return Engine(w);
+}
+
+/*
+ * runs in the child. this only does an atomic increment and jump arithmetic, no
+ * allocation.
+ */
+template <class Engine>
+void basic_stream_registry<Engine>::reposition(void *owner, void *target){
+	static_cast<basic_stream_registry*>(owner)->position(*static_cast<Engine*>(target));
+}
+
+#if XOSHIRO256_IMPL
+
+namespace xoshiro_detail {
+
+/*
+ * pthread_atfork handlers can't be removed, so they are installed once per
+ * process, by the first attach()
+ */
+XOSHIRO256_DECL void fork_hooks::add(void *owner, void *target, hook f){
+	static std::once_flag once;
+	std::call_once(once, []{
+		pthread_atfork(&fork_hooks::before_fork, &fork_hooks::after_fork_parent, &fork_hooks::after_fork_child);
+	});
+	std::lock_guard<std::mutex> g(lock());
+	const entry e = { owner, target, f };
+	entries().push_back(e);
+}
+
+/*
+ * forget owner's entry for target, or all of them
+ */
+XOSHIRO256_DECL void fork_hooks::remove(void *owner, void *target){
+	std::lock_guard<std::mutex> g(lock());
+	std::vector<entry> &v = entries();
+	for(size_t i = 0; i < v.size();)
+		if(v[i].owner == owner && (!target || v[i].target == target)){
+			v[i] = v.back();
+			v.pop_back();
+		} else {
+			i++;
+		}
+}
+
+/*
+ * process-wide state for the fork handlers
+ */
+XOSHIRO256_DECL std::mutex& fork_hooks::lock(){
+	static std::mutex m;
+	return m;
+}
+
+/*
+ * process-wide list of attached engines
+ */
+XOSHIRO256_DECL std::vector<fork_hooks::entry>& fork_hooks::entries(){
+	static std::vector<entry> v;
+	return v;
+}
+
+/*
+ * holding the lock across fork() means the child never sees the list half-updated
+ */
+XOSHIRO256_DECL void fork_hooks::before_fork(){
+	lock().lock();
+}
+
+/*
+ * nothing to do in the parent
+ */
+XOSHIRO256_DECL void fork_hooks::after_fork_parent(){
+	lock().unlock();
+}
+
+/*
+ * the child moves every attached engine to a slot of its own
+ */
+XOSHIRO256_DECL void fork_hooks::after_fork_child(){
+	for(const entry &e : entries())
+		e.f(e.owner, e.target);
+	lock().unlock();
+}
+
+} // namespace xoshiro_detail
+
+#endif /* XOSHIRO256_IMPL */
+
+/*
+ * the registry is a template, so any engine works in either mode;
+ * stream_registry itself is instantiated once in src/xoshiro256.cpp with the
+ * compiled library, see xoshiro256_core.hpp
+ */
+#if !XOSHIRO256_IMPL
+extern template class basic_stream_registry<xoshiro256ss>;
+#endif
+
+#endif /* XOSHIRO256_SHM_HPP_ */
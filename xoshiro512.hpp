@@ -0,0 +1,162 @@
+/*
+ * xoshiro512.hpp
+ *
+ *  xoshiro512**, xoshiro512+ and xoshiro512++, the large-state versions of
+ *  xoshiro256, for runs that need more than 2^64 streams or longer streams than
+ *  2^128 values apart. Based off of the C code on Sebastiano Vigna's website:
+ *  http://prng.di.unimi.it/xoshiro512starstar.c
+ *  http://prng.di.unimi.it/xoshiro512plus.c
+ *  http://prng.di.unimi.it/xoshiro512plusplus.c
+ *
+ *  The engines are the engine template of xoshiro256_core.hpp over the family
+ *  below, with eight words of state instead of four, so they have every member
+ *  of xoshiro256ss and xoshiro256p, and everything that takes an engine
+ *  (engine_array, interleaved<N>, parallel_fill, engine_pool, the replay log,
+ *  the instrument counters, the state formatters) takes these too:
+ *
+ *      engine_pool<xoshiro512ss> pool(64, xoshiro512ss());
+ *
+ *  jump() moves 2^256 values ahead and long_jump() 2^384, so a pool or a
+ *  per-thread set has 2^256 non-overlapping streams of 2^256 values. The
+ *  constants are the reference ones; xoshiro_selfcheck checks them against
+ *  x^(2^256) and x^(2^384) computed in gf2_field<8>.
+ *
+ *  ---------------------Original Xoshiro512** Comments---------------------
+ *
+ *  Written in 2018 by David Blackman and Sebastiano Vigna (vigna@acm.org)
+ *
+ *  To the extent possible under law, the author has dedicated all copyright
+ *  and related and neighboring rights to this software to the public domain
+ *  worldwide. This software is distributed without any warranty.
+ *
+ *  See <http://creativecommons.org/publicdomain/zero/1.0/>.
+ *
+ *  This is xoshiro512** 1.0, one of our all-purpose, rock-solid generators
+ *  with increased state size. It has excellent (about 1ns) speed, a state
+ *  (512 bits) that is large enough for any parallel application, and it
+ *  passes all tests we are aware of.
+ *
+ *  For generating just floating-point numbers, xoshiro512+ is even faster.
+ *
+ *  The state must be seeded so that it is not everywhere zero. If you have
+ *  a 64-bit seed, we suggest to seed a splitmix64 generator and use its
+ *  output to fill s.
+ *
+ *  ---------------------Original Xoshiro512+ Comments---------------------
+ *
+ *  This is xoshiro512+ 1.0, our generator for floating-point numbers with
+ *  increased state size. We suggest to use its upper bits for
+ *  floating-point generation, as it is slightly faster than xoshiro512**.
+ *  It passes all tests we are aware of except for the lowest three bits,
+ *  which might fail linearity tests (and just those), so if low linear
+ *  complexity is not considered an issue (as it is usually the case) it
+ *  can be used to generate 64-bit outputs, too.
+ *
+ *  ---------------------Original Xoshiro512++ Comments---------------------
+ *
+ *  This is xoshiro512++ 1.0, one of our all-purpose, rock-solid generators.
+ *  It has excellent (about 1ns) speed, a state (512 bits) that is large
+ *  enough for any parallel application, and it passes all tests we are
+ *  aware of.
+ */
+#ifndef XOSHIRO512_HPP_
+#define XOSHIRO512_HPP_
+
+#include "xoshiro256_core.hpp"
+
+namespace xoshiro_detail {
+
+/*
+ * the xoshiro512 state transition and its output functions, see
+ * xoshiro256_family. applying a polynomial walks 512 steps and the power is
+ * over twice the words, so advance() and retreat() step through a longer
+ * range than for xoshiro256.
+ */
+struct xoshiro512_family {
+	typedef uint64_t word; // the type of a state word and of a value
+	enum : unsigned { words = 8 }; // state words
+	enum : bool { ring = false }; // whether the words are a ring that p moves around
+	enum : uint64_t { advance_steps = 8192, retreat_steps = 16384 }; // distances advance() and retreat() walk instead of using the field
+	static constexpr const uint64_t* jump_poly() { return jump_tables<>::xoshiro512; } // 2^256 steps
+	static constexpr const uint64_t* long_jump_poly() { return jump_tables<>::xoshiro512_long; } // 2^384 steps
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned step(S s, unsigned p); // one step of the state, returns the new p
+	template <class S>
+	static XOSHIRO_CONSTEXPR14 unsigned unstep(S s, unsigned p); // the inverse of step()
+
+	struct starstar { // xoshiro512**
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned) { return rotl(s[1] * 5, 7) * 9; }
+	};
+	struct plus { // xoshiro512+
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned) { return s[0] + s[2]; }
+	};
+	struct plusplus { // xoshiro512++
+		template <class S>
+		static constexpr uint64_t scramble(S s, unsigned) { return rotl(s[0] + s[2], 17) + s[2]; }
+	};
+};
+
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoshiro512_family::step(S s, unsigned p) {
+	const uint64_t t = s[1] << 11;
+
+	s[2] ^= s[0];
+	s[5] ^= s[1];
+	s[1] ^= s[2];
+	s[7] ^= s[3];
+	s[3] ^= s[4];
+	s[4] ^= s[5];
+	s[0] ^= s[6];
+	s[6] ^= s[7];
+
+	s[6] ^= t;
+
+	s[7] = rotl(s[7], 21);
+	return p;
+}
+
+/*
+ * step() undone. every new word is an xor of at most four old ones, and
+ * they come back one at a time in this order; unlike xoshiro256 no shift has
+ * to be inverted, since t is xored into a word whose other terms are known.
+ */
+template <class S>
+XOSHIRO_CONSTEXPR14 unsigned xoshiro512_family::unstep(S s, unsigned p) {
+	const uint64_t s1 = s[1] ^ s[2];
+	const uint64_t s5 = s[5] ^ s1;
+	const uint64_t s4 = s[4] ^ s[5];
+	const uint64_t s3 = s[3] ^ s4;
+	const uint64_t s7s3 = rotl(s[7], 64 - 21);
+	const uint64_t s6 = s[6] ^ s7s3 ^ (s1 << 11);
+	const uint64_t s0 = s[0] ^ s6;
+
+	s[2] ^= s0;
+	s[0] = s0;
+	s[1] = s1;
+	s[3] = s3;
+	s[4] = s4;
+	s[5] = s5;
+	s[6] = s6;
+	s[7] = s7s3 ^ s3;
+	return p;
+}
+
+} // namespace xoshiro_detail
+
+typedef xoshiro_engine<xoshiro_detail::xoshiro512_family> xoshiro512ss; // xoshiro512**
+typedef xoshiro_scrambled<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plus> xoshiro512p; // xoshiro512+
+typedef xoshiro_scrambled<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plusplus> xoshiro512pp; // xoshiro512++
+
+/*
+ * instantiated once in src/xoshiro256.cpp with the compiled library, see
+ * xoshiro256_core.hpp
+ */
+#if !XOSHIRO256_IMPL
+extern template class xoshiro_engine<xoshiro_detail::xoshiro512_family>;
+extern template class xoshiro_scrambled<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plus>;
+extern template class xoshiro_scrambled<xoshiro_detail::xoshiro512_family, xoshiro_detail::xoshiro512_family::plusplus>;
+#endif
+
+#endif /* XOSHIRO512_HPP_ */